@@ -0,0 +1,293 @@
+// 无界面引擎的端到端测试：生成一段音视频素材，经 CPU 灰度滤镜转码，再用无界面播放器实时播放，
+// 检查输出文件的流、帧数、画面颜色以及播放器送出的帧。不依赖 Qt / OpenGL 和外部素材文件
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#include "IHeadlessPlayer.h"
+#include "ITranscoder.h"
+#include "Interface/IFileWriter.h"
+
+namespace {
+
+constexpr int kWidth = 160;
+constexpr int kHeight = 120;
+constexpr int kFps = 25;
+constexpr int kFrameCount = 50;         // 2 秒视频
+constexpr int kSampleRate = 44100;
+constexpr int kChannels = 2;
+constexpr int kAudioFrameSize = 1024;   // 与音频编码器的帧长一致
+constexpr int kChromaTolerance = 4;     // 灰度画面的 U/V 与 128 的最大偏差
+
+bool Check(bool condition, const std::string& message) {
+    if (!condition) std::cerr << "FAILED: " << message << std::endl;
+    return condition;
+}
+
+// 等待异步回调结束
+class Completion {
+public:
+    void Signal(bool success) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+        m_success = success;
+        m_cond.notify_all();
+    }
+
+    // 超时返回 false
+    bool Wait(std::chrono::seconds timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cond.wait_for(lock, timeout, [this]() { return m_finished; }) && m_success;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_finished{false};
+    bool m_success{false};
+};
+
+class WriterListener : public av::IFileWriter::Listener {
+public:
+    void OnFileWriterNotifyFinished() override { completion.Signal(true); }
+    Completion completion;
+};
+
+class TranscoderListener : public av::ITranscoder::Listener {
+public:
+    void OnTranscoderNotifyProgress(float timeStamp, float duration) override {}
+    void OnTranscoderNotifyFinished(bool success) override { completion.Signal(success); }
+    Completion completion;
+};
+
+class PlayerListener : public av::IHeadlessPlayer::Listener, public av::IPlaybackListener {
+public:
+    void OnHeadlessPlayerNotifyVideoFrame(std::shared_ptr<av::IVideoFrame> videoFrame) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (videoFrame && (videoFrame->avFrame || videoFrame->data)) m_videoFrameCount++;
+    }
+
+    void NotifyPlaybackStarted() override {}
+    void NotifyPlaybackTimeChanged(float timeStamp, float duration) override {}
+    void NotifyPlaybackPaused() override {}
+    void NotifyPlaybackEOF() override { completion.Signal(true); }
+
+    int GetVideoFrameCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_videoFrameCount;
+    }
+
+    Completion completion;
+
+private:
+    std::mutex m_mutex;
+    int m_videoFrameCount{0};
+};
+
+// 用软件编码器写出带彩色画面和正弦波音频的素材
+bool WriteFixture(const std::string& path) {
+    WriterListener listener;
+    auto writer = std::shared_ptr<av::IFileWriter>(av::IFileWriter::CreateSoftware());
+    writer->SetListener(&listener);
+
+    av::FileWriterParameters parameters;
+    parameters.width = kWidth;
+    parameters.height = kHeight;
+    parameters.fps = kFps;
+    parameters.sampleRate = kSampleRate;
+    parameters.channels = kChannels;
+    if (!Check(writer->StartWriter(path, parameters, 0), "start fixture writer")) return false;
+
+    const size_t frameBytes = static_cast<size_t>(kWidth) * kHeight * 4;
+    for (int i = 0; i < kFrameCount; ++i) {
+        // 饱和的红绿交替画面，色度明显偏离灰度
+        auto data = std::shared_ptr<uint8_t>(new uint8_t[frameBytes], std::default_delete<uint8_t[]>());
+        for (size_t pixel = 0; pixel < frameBytes; pixel += 4) {
+            data.get()[pixel + 0] = (i % 2 == 0) ? 220 : 20;
+            data.get()[pixel + 1] = (i % 2 == 0) ? 20 : 220;
+            data.get()[pixel + 2] = 20;
+            data.get()[pixel + 3] = 255;
+        }
+        auto videoFrame = std::make_shared<av::IVideoFrame>();
+        videoFrame->width = kWidth;
+        videoFrame->height = kHeight;
+        videoFrame->pts = i;
+        videoFrame->duration = 1;
+        videoFrame->timebaseNum = 1;
+        videoFrame->timebaseDen = kFps;
+        videoFrame->data = data;
+        writer->NotifyVideoFrame(videoFrame);
+    }
+
+    const int audioChunkCount = (kFrameCount * kSampleRate / kFps + kAudioFrameSize - 1) / kAudioFrameSize;
+    for (int chunk = 0; chunk < audioChunkCount; ++chunk) {
+        auto audioSamples = std::make_shared<av::IAudioSamples>();
+        audioSamples->channels = kChannels;
+        audioSamples->sampleRate = kSampleRate;
+        audioSamples->pts = static_cast<int64_t>(chunk) * kAudioFrameSize;
+        audioSamples->duration = kAudioFrameSize;
+        audioSamples->timebaseNum = 1;
+        audioSamples->timebaseDen = kSampleRate;
+        audioSamples->pcmData.resize(static_cast<size_t>(kAudioFrameSize) * kChannels);
+        for (int i = 0; i < kAudioFrameSize; ++i) {
+            double t = static_cast<double>(chunk * kAudioFrameSize + i) / kSampleRate;
+            auto value = static_cast<int16_t>(std::sin(2.0 * 3.14159265358979 * 440.0 * t) * 8000.0);
+            for (int ch = 0; ch < kChannels; ++ch) audioSamples->pcmData[static_cast<size_t>(i) * kChannels + ch] = value;
+        }
+        writer->NotifyAudioSamples(audioSamples);
+    }
+
+    writer->NotifyAudioFinished();
+    writer->NotifyVideoFinished();
+    bool finished = listener.completion.Wait(std::chrono::seconds(60));
+    writer->SetListener(nullptr);
+    return Check(finished, "fixture writer finished");
+}
+
+// 解码输出文件，统计视频帧数并检查画面中心的色度
+struct ProbeResult {
+    bool hasAudio{false};
+    int videoFrameCount{0};
+    int colorFrameCount{0};     // 色度偏离灰度的帧数
+    double duration{0.0};
+};
+
+bool ProbeFile(const std::string& path, ProbeResult& result) {
+    AVFormatContext* formatCtx = nullptr;
+    if (avformat_open_input(&formatCtx, path.c_str(), nullptr, nullptr) < 0) return Check(false, "open " + path);
+    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+        avformat_close_input(&formatCtx);
+        return Check(false, "find stream info " + path);
+    }
+    result.hasAudio = av_find_best_stream(formatCtx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0) >= 0;
+    if (formatCtx->duration != AV_NOPTS_VALUE) result.duration = formatCtx->duration / static_cast<double>(AV_TIME_BASE);
+
+    int videoIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    const AVCodec* codec =
+        videoIndex >= 0 ? avcodec_find_decoder(formatCtx->streams[videoIndex]->codecpar->codec_id) : nullptr;
+    AVCodecContext* codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+    bool opened = codecCtx && avcodec_parameters_to_context(codecCtx, formatCtx->streams[videoIndex]->codecpar) >= 0 &&
+                  avcodec_open2(codecCtx, codec, nullptr) >= 0;
+    if (!opened) {
+        avcodec_free_context(&codecCtx);
+        avformat_close_input(&formatCtx);
+        return Check(false, "open video decoder for " + path);
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    auto receiveFrames = [&]() {
+        while (avcodec_receive_frame(codecCtx, frame) >= 0) {
+            result.videoFrameCount++;
+            // 编码输出为 YUV420P，取画面中心的色度
+            int x = frame->width / 4;
+            int y = frame->height / 4;
+            int u = frame->data[1][y * frame->linesize[1] + x];
+            int v = frame->data[2][y * frame->linesize[2] + x];
+            if (std::abs(u - 128) > kChromaTolerance || std::abs(v - 128) > kChromaTolerance) result.colorFrameCount++;
+            av_frame_unref(frame);
+        }
+    };
+    while (av_read_frame(formatCtx, packet) >= 0) {
+        if (packet->stream_index == videoIndex && avcodec_send_packet(codecCtx, packet) >= 0) receiveFrames();
+        av_packet_unref(packet);
+    }
+    avcodec_send_packet(codecCtx, nullptr);
+    receiveFrames();
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&codecCtx);
+    avformat_close_input(&formatCtx);
+    return true;
+}
+
+bool TestFixture(const std::string& path) {
+    ProbeResult result;
+    if (!ProbeFile(path, result)) return false;
+    bool ok = Check(result.hasAudio, "fixture has audio");
+    ok &= Check(result.videoFrameCount == kFrameCount,
+                "fixture has " + std::to_string(kFrameCount) + " frames, got " + std::to_string(result.videoFrameCount));
+    ok &= Check(result.colorFrameCount == result.videoFrameCount, "fixture frames are colored");
+    return ok;
+}
+
+bool TestTranscode(const std::string& inputPath, const std::string& outputPath) {
+    TranscoderListener listener;
+    auto transcoder = std::shared_ptr<av::ITranscoder>(av::ITranscoder::Create());
+    transcoder->SetListener(&listener);
+    if (!Check(transcoder->Open(inputPath), "transcoder open")) return false;
+    if (!Check(transcoder->AddVideoFilter(av::VideoFilterType::kGray) != nullptr, "add gray filter")) return false;
+    if (!Check(transcoder->Start(outputPath, 0), "transcoder start")) return false;
+    bool finished = listener.completion.Wait(std::chrono::seconds(60));
+    transcoder->SetListener(nullptr);
+    transcoder = nullptr;
+    if (!Check(finished, "transcoder finished successfully")) return false;
+
+    ProbeResult result;
+    if (!ProbeFile(outputPath, result)) return false;
+    bool ok = Check(result.hasAudio, "transcoded file has audio");
+    ok &= Check(result.videoFrameCount == kFrameCount, "transcoded file has " + std::to_string(kFrameCount) +
+                                                           " frames, got " + std::to_string(result.videoFrameCount));
+    ok &= Check(result.colorFrameCount == 0, "transcoded frames are gray, colored frames: " +
+                                                 std::to_string(result.colorFrameCount));
+    ok &= Check(std::abs(result.duration - static_cast<double>(kFrameCount) / kFps) < 0.5,
+                "transcoded duration " + std::to_string(result.duration));
+    return ok;
+}
+
+bool TestHeadlessPlayback(const std::string& path) {
+    auto listener = std::make_shared<PlayerListener>();
+    auto player = std::shared_ptr<av::IHeadlessPlayer>(av::IHeadlessPlayer::Create());
+    player->SetListener(listener.get());
+    player->SetPlaybackListener(listener);
+    if (!Check(player->Open(path), "headless player open")) return false;
+
+    player->Play();
+    bool reachedEnd = listener->completion.Wait(std::chrono::seconds(30));
+    // 音频结束时最后几帧视频可能仍在送出
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    player->Pause();
+    auto stats = player->GetVideoPresentationStats();
+    player->SetListener(nullptr);
+    player->SetPlaybackListener(nullptr);
+    player = nullptr;
+
+    bool ok = Check(reachedEnd, "headless playback reached EOF");
+    // 实时播放允许丢弃少量落后的帧
+    ok &= Check(listener->GetVideoFrameCount() >= kFrameCount * 8 / 10,
+                "headless player delivered frames: " + std::to_string(listener->GetVideoFrameCount()));
+    ok &= Check(stats.presentedFrames > 0, "presentation stats recorded frames");
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "avplayer_headless_test";
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    std::string fixturePath = (directory / "fixture.mp4").u8string();
+    std::string transcodedPath = (directory / "transcoded.mp4").u8string();
+
+    bool ok = WriteFixture(fixturePath) && TestFixture(fixturePath);
+    ok = ok && TestTranscode(fixturePath, transcodedPath);
+    ok = ok && TestHeadlessPlayback(transcodedPath);
+
+    std::filesystem::remove_all(directory, ec);
+    std::cout << (ok ? "headless_test passed" : "headless_test failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+// SPSCQueue 与 mutex + std::list 在两个线程之间逐个传递元素的耗时对比
+// 由 CMake 目标 spsc_queue_bench 构建；元素缺失或乱序时返回非 0
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Core/SPSCQueue.h"
+
+namespace {
+
+constexpr int kItemCount = 2000000;
+constexpr size_t kCapacity = 64;
+
+struct Item {
+    int64_t pts{0};
+};
+
+double BenchSPSCQueue(bool& ordered) {
+    av::SPSCQueue<std::shared_ptr<Item>> queue(kCapacity);
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&queue] {
+        for (int i = 0; i < kItemCount; ++i) {
+            auto item = std::make_shared<Item>();
+            item->pts = i;
+            // 队列满时阻塞等待消费者，与流水线中的用法一致
+            queue.Push(item, [] { return false; });
+        }
+    });
+
+    int64_t sum = 0;
+    std::shared_ptr<Item> item;
+    for (int i = 0; i < kItemCount; ++i) {
+        while (!queue.TryPop(item)) std::this_thread::yield();
+        if (item->pts != i) ordered = false;
+        sum += item->pts;
+    }
+    producer.join();
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sum < 0) std::cout << sum << std::endl;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / kItemCount;
+}
+
+double BenchMutexList() {
+    std::list<std::shared_ptr<Item>> queue;
+    std::mutex mutex;
+    std::condition_variable cond;
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&] {
+        for (int i = 0; i < kItemCount; ++i) {
+            auto item = std::make_shared<Item>();
+            item->pts = i;
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&] { return queue.size() < kCapacity; });
+            queue.push_back(item);
+            cond.notify_all();
+        }
+    });
+
+    int64_t sum = 0;
+    for (int i = 0; i < kItemCount; ++i) {
+        std::shared_ptr<Item> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&] { return !queue.empty(); });
+            item = queue.front();
+            queue.pop_front();
+            cond.notify_all();
+        }
+        sum += item->pts;
+    }
+    producer.join();
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sum < 0) std::cout << sum << std::endl;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / kItemCount;
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "items: " << kItemCount << ", capacity: " << kCapacity << std::endl;
+    bool ordered = true;
+    std::cout << "SPSCQueue:         " << BenchSPSCQueue(ordered) << " ns/item" << std::endl;
+    std::cout << "mutex + std::list: " << BenchMutexList() << " ns/item" << std::endl;
+    if (!ordered) {
+        std::cerr << "SPSCQueue lost or reordered items" << std::endl;
+        return 1;
+    }
+    return 0;
+}
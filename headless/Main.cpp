@@ -0,0 +1,75 @@
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "ITranscoder.h"
+
+namespace {
+
+// 等待转码结束并打印进度
+class TranscodeListener : public av::ITranscoder::Listener {
+public:
+    void OnTranscoderNotifyProgress(float timeStamp, float duration) override {
+        std::cout << "\rprogress: " << timeStamp << " / " << duration << std::flush;
+    }
+
+    void OnTranscoderNotifyFinished(bool success) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+        m_success = success;
+        m_cond.notify_all();
+    }
+
+    bool Wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this]() { return m_finished; });
+        return m_success;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_finished{false};
+    bool m_success{false};
+};
+
+av::VideoFilterType ParseFilterType(const char* name) {
+    if (std::strcmp(name, "gray") == 0) return av::VideoFilterType::kGray;
+    if (std::strcmp(name, "invert") == 0) return av::VideoFilterType::kInvert;
+    if (std::strcmp(name, "flip") == 0) return av::VideoFilterType::kFlipVertical;
+    return av::VideoFilterType::kNone;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <input> <output.mp4> [gray|invert|flip]..." << std::endl;
+        return 1;
+    }
+
+    TranscodeListener listener;
+    auto transcoder = std::shared_ptr<av::ITranscoder>(av::ITranscoder::Create());
+    transcoder->SetListener(&listener);
+    if (!transcoder->Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    for (int i = 3; i < argc; ++i) {
+        auto type = ParseFilterType(argv[i]);
+        if (type == av::VideoFilterType::kNone || !transcoder->AddVideoFilter(type)) {
+            std::cerr << "Unsupported filter: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if (!transcoder->Start(argv[2], 0)) return 1;
+    bool success = listener.Wait();
+    std::cout << std::endl << (success ? "done" : "stopped") << std::endl;
+
+    transcoder->SetListener(nullptr);
+    return success ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Define/IAudioSamples.h"
+#include "Define/IVideoFrame.h"
+#include "Define/SeekMode.h"
+#include "Define/SyncClockType.h"
+#include "Define/VideoPresentationStats.h"
+#include "IPlaybackListener.h"
+#include "IVideoFilter.h"
+#include <memory>
+#include <string>
+
+namespace av {
+
+// 无界面播放器：不依赖 Qt 与 OpenGL，帧始终位于系统内存中，滤镜在 CPU 上执行
+struct IHeadlessPlayer {
+    struct Listener {
+        // 添加滤镜后为 RGBA 数据（data），否则为解码器输出的 YUV 数据（avFrame）
+        virtual void OnHeadlessPlayerNotifyVideoFrame(std::shared_ptr<IVideoFrame>) = 0;
+        virtual void OnHeadlessPlayerNotifyAudioSamples(std::shared_ptr<IAudioSamples>) {}
+        virtual ~Listener() = default;
+    };
+
+    virtual void SetListener(Listener *listener) = 0;
+    virtual void SetPlaybackListener(std::shared_ptr<IPlaybackListener> listener) = 0;
+
+    virtual bool Open(const std::string &filePath) = 0;
+    virtual void Play() = 0;
+    virtual void Pause() = 0;
+    virtual void SeekTo(float progress, SeekMode mode = SeekMode::kExact) = 0;
+    virtual bool IsPlaying() = 0;
+    // 音画同步的主时钟，默认 kAuto
+    virtual void SetSyncClockType(SyncClockType type) = 0;
+    // 播放倍速，范围 0.25 ~ 4.0，超出范围取边界值；音频变速不变调，画面按倍速抽帧或停留
+    virtual void SetPlaybackRate(float rate) = 0;
+    virtual float GetPlaybackRate() = 0;
+    // 视频按时钟送出的统计（送出、落后、丢弃、抽掉、解码器跳过的帧数及送出时刻的偏差），任意线程可调用
+    virtual VideoPresentationStats GetVideoPresentationStats() = 0;
+
+    // 不支持的滤镜类型（如贴纸）返回 nullptr
+    virtual std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) = 0;
+    virtual void RemoveVideoFilter(VideoFilterType type) = 0;
+
+    virtual bool StartRecording(const std::string &outputFilePath, int flags) = 0;
+    virtual void StopRecording() = 0;
+    virtual bool IsRecording() = 0;
+
+    virtual ~IHeadlessPlayer() = default;
+
+    static IHeadlessPlayer *Create();
+};
+
+}
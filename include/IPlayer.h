@@ -3,6 +3,9 @@
 #include "Interface/IVideoDisplayView.h"
 #include "IPlaybackListener.h"
 #include "IVideoFilter.h"
+#include "Define/SeekMode.h"
+#include "Define/SyncClockType.h"
+#include "Define/VideoPresentationStats.h"
 #include <string>
 #include <memory>
 
@@ -17,8 +20,15 @@ struct IPlayer {
     virtual bool Open(std::string &filePath) = 0;
     virtual void Play() = 0;
     virtual void Pause() = 0;
-    virtual void SeekTo(float progress) = 0;
+    virtual void SeekTo(float progress, SeekMode mode = SeekMode::kExact) = 0;
     virtual bool IsPlaying() = 0;
+    // 音画同步的主时钟，默认 kAuto
+    virtual void SetSyncClockType(SyncClockType type) = 0;
+    // 播放倍速，范围 0.25 ~ 4.0，超出范围取边界值；音频变速不变调，画面按倍速抽帧或停留
+    virtual void SetPlaybackRate(float rate) = 0;
+    virtual float GetPlaybackRate() = 0;
+    // 视频按时钟送出的统计（送出、落后、丢弃、抽掉、解码器跳过的帧数及送出时刻的偏差），任意线程可调用
+    virtual VideoPresentationStats GetVideoPresentationStats() = 0;
 
     virtual std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) = 0;
     virtual void RemoveVideoFilter(VideoFilterType type) = 0;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "IVideoFilter.h"
+#include <memory>
+#include <string>
+
+namespace av {
+
+// 无界面转码器：不按真实时间播放，解码后尽快经过 CPU 滤镜并编码输出
+struct ITranscoder {
+    struct Listener {
+        virtual void OnTranscoderNotifyProgress(float timeStamp, float duration) = 0;
+        // success 为 false 表示被 Stop 中止
+        virtual void OnTranscoderNotifyFinished(bool success) = 0;
+        virtual ~Listener() = default;
+    };
+
+    virtual void SetListener(Listener *listener) = 0;
+    virtual bool Open(const std::string &filePath) = 0;
+
+    // 不支持的滤镜类型（如贴纸）返回 nullptr
+    virtual std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) = 0;
+    virtual void RemoveVideoFilter(VideoFilterType type) = 0;
+
+    virtual bool Start(const std::string &outputFilePath, int flags) = 0;
+    virtual void Stop() = 0;
+    virtual bool IsRunning() = 0;
+
+    virtual ~ITranscoder() = default;
+
+    static ITranscoder *Create();
+};
+
+}
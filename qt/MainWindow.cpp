@@ -42,6 +42,7 @@ MainWindow::MainWindow() : QWidget() {
     m_progressSlider->setValue(0);
     // 连接进度条的 sliderMoved 信号到自定义的槽函数
     connect(m_progressSlider, &QSlider::sliderMoved, this, &MainWindow::onSliderMoved);
+    connect(m_progressSlider, &QSlider::sliderReleased, this, &MainWindow::onSliderReleased);
     vbox->addWidget(m_progressSlider);
     
     m_controllerWidget = new ControllerWidget(this, m_player);
@@ -85,8 +86,15 @@ void MainWindow::mouseDoubleClickEvent(QMouseEvent *event) {
 }
 
 void MainWindow::onSliderMoved(int value) {
-    // 处理进度条滑动事件
+    // 拖动过程中快速跳转到最近的关键帧
     if (m_player) {
-        m_player->SeekTo(static_cast<float>(value) / 1000);
+        m_player->SeekTo(static_cast<float>(value) / 1000, av::SeekMode::kFast);
+    }
+}
+
+void MainWindow::onSliderReleased() {
+    // 松开后精确跳转到目标位置
+    if (m_player) {
+        m_player->SeekTo(static_cast<float>(m_progressSlider->value()) / 1000, av::SeekMode::kExact);
     }
 }
\ No newline at end of file
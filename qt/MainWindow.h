@@ -47,6 +47,7 @@ protected:
 
 private slots:
     void onSliderMoved(int value);
+    void onSliderReleased();
 
 private:
     friend class PlaybackListener;
@@ -0,0 +1,75 @@
+#include "FrameBufferPool.h"
+
+namespace av {
+
+FrameBufferPool::FrameBufferPool(size_t maxBuffersPerBucket) : m_maxBuffersPerBucket(maxBuffersPerBucket) {}
+
+FrameBufferPool::~FrameBufferPool() { Trim(); }
+
+size_t FrameBufferPool::GetBucketSize(size_t size) {
+    // 按 4KB 对齐分桶，同一分辨率的帧总是落在同一个桶
+    constexpr size_t kAlignment = 4096;
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+std::shared_ptr<uint8_t> FrameBufferPool::Acquire(size_t size) {
+    size_t bucketSize = GetBucketSize(size);
+    uint8_t* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& bucket = m_buckets[bucketSize];
+        if (!bucket.empty()) {
+            buffer = bucket.back();
+            bucket.pop_back();
+            m_stats.reuses++;
+            m_stats.cachedBuffers--;
+            m_stats.cachedBytes -= bucketSize;
+        } else {
+            m_stats.allocations++;
+        }
+        m_stats.outstanding++;
+    }
+    if (!buffer) buffer = new uint8_t[bucketSize];
+
+    // 缓冲区释放时归还到池中；池已销毁则直接释放
+    std::weak_ptr<FrameBufferPool> weakPool = weak_from_this();
+    return std::shared_ptr<uint8_t>(buffer, [weakPool, bucketSize](uint8_t* buffer) {
+        if (auto pool = weakPool.lock()) {
+            pool->Recycle(buffer, bucketSize);
+        } else {
+            delete[] buffer;
+        }
+    });
+}
+
+void FrameBufferPool::Recycle(uint8_t* buffer, size_t bucketSize) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.outstanding--;
+        auto& bucket = m_buckets[bucketSize];
+        if (bucket.size() < m_maxBuffersPerBucket) {
+            bucket.push_back(buffer);
+            m_stats.cachedBuffers++;
+            m_stats.cachedBytes += bucketSize;
+            return;
+        }
+    }
+    delete[] buffer;
+}
+
+void FrameBufferPool::Trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [bucketSize, bucket] : m_buckets) {
+        for (auto buffer : bucket) delete[] buffer;
+    }
+    m_buckets.clear();
+    m_stats.cachedBuffers = 0;
+    m_stats.cachedBytes = 0;
+}
+
+FrameBufferPoolStats FrameBufferPool::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+}  // namespace av
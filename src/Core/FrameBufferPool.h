@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace av {
+
+// 缓冲池统计信息
+struct FrameBufferPoolStats {
+    size_t allocations{0};      // 实际向堆申请内存的次数
+    size_t reuses{0};           // 从池中复用的次数
+    size_t outstanding{0};      // 当前被帧持有、尚未归还的缓冲区数量
+    size_t cachedBuffers{0};    // 池中空闲缓冲区数量
+    size_t cachedBytes{0};      // 池中空闲缓冲区总字节数
+};
+
+// 按尺寸分桶的帧缓冲池，缓冲区随 shared_ptr 释放自动归还，稳态播放时不再产生大块内存分配
+class FrameBufferPool : public std::enable_shared_from_this<FrameBufferPool> {
+public:
+    explicit FrameBufferPool(size_t maxBuffersPerBucket = 8);
+    ~FrameBufferPool();
+
+    // 获取至少 size 字节的缓冲区
+    std::shared_ptr<uint8_t> Acquire(size_t size);
+    // 释放所有空闲缓冲区
+    void Trim();
+
+    FrameBufferPoolStats GetStats();
+
+private:
+    void Recycle(uint8_t* buffer, size_t bucketSize);
+    static size_t GetBucketSize(size_t size);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<size_t, std::vector<uint8_t*>> m_buckets;
+    size_t m_maxBuffersPerBucket{8};
+    FrameBufferPoolStats m_stats;
+};
+
+}  // namespace av
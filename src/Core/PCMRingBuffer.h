@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace av {
+
+// 预分配的无锁单生产者/单消费者 PCM 环形缓冲区
+// 仅允许一个线程调用 Write，一个线程调用 Read/DiscardUntil，读写都不分配内存、不加锁，
+// 用于向音频设备的实时回调提供数据，回调只拷贝本次需要输出的样本
+class PCMRingBuffer {
+public:
+    explicit PCMRingBuffer(size_t capacity) {
+        // 容量向上取整为 2 的幂，下标可以用位与代替取模
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    PCMRingBuffer(const PCMRingBuffer&) = delete;
+    PCMRingBuffer& operator=(const PCMRingBuffer&) = delete;
+
+    // 生产者调用，写入尽可能多的样本，返回实际写入的样本数
+    size_t Write(const int16_t* samples, size_t count) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (Capacity() - (tail - m_cachedHead) < count) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+        }
+        count = std::min(count, Capacity() - (tail - m_cachedHead));
+        if (count == 0) return 0;
+
+        const size_t start = tail & m_mask;
+        const size_t first = std::min(count, Capacity() - start);
+        std::memcpy(m_buffer.data() + start, samples, first * sizeof(int16_t));
+        std::memcpy(m_buffer.data(), samples + first, (count - first) * sizeof(int16_t));
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // 消费者调用，最多读出 count 个样本到 dst（无对齐要求），返回实际读出的样本数
+    size_t Read(void* dst, size_t count) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_cachedTail - head < count) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+        count = std::min(count, m_cachedTail - head);
+        if (count == 0) return 0;
+
+        const size_t start = head & m_mask;
+        const size_t first = std::min(count, Capacity() - start);
+        auto* bytes = static_cast<uint8_t*>(dst);
+        std::memcpy(bytes, m_buffer.data() + start, first * sizeof(int16_t));
+        std::memcpy(bytes + first * sizeof(int16_t), m_buffer.data(), (count - first) * sizeof(int16_t));
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // 消费者调用，丢弃写入位置 position 之前的样本
+    void DiscardUntil(size_t position) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (static_cast<std::ptrdiff_t>(position - head) <= 0) return;
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        m_head.store(head + std::min(position - head, m_cachedTail - head), std::memory_order_release);
+    }
+
+    // 累计写入的样本数，任意线程可调用
+    size_t WritePosition() const { return m_tail.load(std::memory_order_acquire); }
+
+    // 累计读出（含丢弃）的样本数，任意线程可调用
+    size_t ReadPosition() const { return m_head.load(std::memory_order_acquire); }
+
+    size_t Size() const {
+        // 先读 head 再读 tail，保证 tail >= head
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    std::vector<int16_t> m_buffer;
+    size_t m_mask{0};
+
+    // 生产者与消费者各自修改的下标放在不同缓存行，避免伪共享
+    alignas(kCacheLineSize) std::atomic<size_t> m_head{0};  // 消费者写
+    size_t m_cachedTail{0};                                  // 消费者缓存的 tail
+    alignas(kCacheLineSize) std::atomic<size_t> m_tail{0};  // 生产者写
+    size_t m_cachedHead{0};                                  // 生产者缓存的 head
+};
+
+}  // namespace av
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace av {
+
+// 有界无锁单生产者/单消费者环形队列
+// 仅允许一个线程调用 TryPush/Push，一个线程调用 TryPop/Front/Pop/Clear，
+// 用于流水线相邻两级之间的数据传递，取代 mutex + std::list 以避免加锁和每个元素一次的节点分配。
+// 队列满时 Push 阻塞等待消费者（反压），只有生产者真正等待时才会用到互斥量
+template <typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t capacity) {
+        // 容量向上取整为 2 的幂，下标可以用位与代替取模
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // 生产者调用，队列已满返回 false
+    bool TryPush(T value) { return TryMoveIn(value); }
+
+    // 生产者调用，队列已满时等待消费者腾出空间，不丢弃数据。
+    // shouldAbort 返回 true 时放弃写入并返回 false；改变中止条件的一方需调用 WakeProducer
+    template <typename Predicate>
+    bool Push(T value, Predicate shouldAbort) {
+        while (!TryMoveIn(value)) {
+            std::unique_lock<std::mutex> lock(m_spaceMutex);
+            m_producerWaiting.store(true, std::memory_order_relaxed);
+            // 与 Pop 中的栅栏配对：要么消费者看到等待标志，要么这里看到新的 head，不会丢失唤醒
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_spaceCondition.wait(lock, [&]() { return !Full() || shouldAbort(); });
+            m_producerWaiting.store(false, std::memory_order_relaxed);
+            if (shouldAbort()) return false;
+        }
+        return true;
+    }
+
+    // 唤醒在 Push 中等待的生产者，使其重新检查中止条件
+    void WakeProducer() {
+        { std::lock_guard<std::mutex> lock(m_spaceMutex); }
+        m_spaceCondition.notify_all();
+    }
+
+    // 消费者调用，队列为空返回 false
+    bool TryPop(T& value) {
+        T* front = Front();
+        if (!front) return false;
+        value = std::move(*front);
+        Pop();
+        return true;
+    }
+
+    // 消费者调用，返回队首元素，队列为空返回 nullptr
+    T* Front() {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) return nullptr;
+        }
+        return &m_buffer[head & m_mask];
+    }
+
+    // 消费者调用，丢弃队首元素
+    void Pop() {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        // 及时释放槽位中的对象（如 shared_ptr 持有的帧），避免被环形缓冲区延长生命周期
+        m_buffer[head & m_mask] = T{};
+        m_head.store(head + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_producerWaiting.load(std::memory_order_relaxed)) WakeProducer();
+    }
+
+    // 消费者调用，清空当前队列中的所有元素
+    void Clear() {
+        while (Front()) Pop();
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    size_t Size() const {
+        // 先读 head 再读 tail，保证 tail >= head
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    // 写入成功才移走 value，失败时调用方仍持有它
+    bool TryMoveIn(T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) return false;
+        }
+        m_buffer[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 生产者调用
+    bool Full() const { return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_acquire) > m_mask; }
+
+    std::vector<T> m_buffer;
+    size_t m_mask{0};
+
+    // 生产者与消费者各自修改的下标放在不同缓存行，避免伪共享
+    alignas(kCacheLineSize) std::atomic<size_t> m_head{0};  // 消费者写
+    size_t m_cachedTail{0};                                  // 消费者缓存的 tail
+    alignas(kCacheLineSize) std::atomic<size_t> m_tail{0};  // 生产者写
+    size_t m_cachedHead{0};                                  // 生产者缓存的 head
+
+    // 反压：生产者等待空间；消费者每次 Pop 都会读取，单独占用缓存行
+    alignas(kCacheLineSize) std::atomic<bool> m_producerWaiting{false};
+    std::mutex m_spaceMutex;
+    std::condition_variable m_spaceCondition;
+};
+
+}  // namespace av
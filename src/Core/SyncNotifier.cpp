@@ -29,6 +29,15 @@ bool SyncNotifier::Wait(int timeoutInMilliseconds) {
     return true;
 }
 
+bool SyncNotifier::WaitUntil(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool triggered = m_cond.wait_until(lock, deadline, [this]() {
+        return m_triggered.load();
+    });
+    Reset();
+    return triggered;
+}
+
 void SyncNotifier::Reset() {
     m_triggered = false;
 }
@@ -13,6 +13,8 @@ public:
 
     void Notify();
     bool Wait(int timeoutInMilliseconds = -1);
+    // 等待到指定时刻或被唤醒，用于按时间点精确调度
+    bool WaitUntil(std::chrono::steady_clock::time_point deadline);
     void Reset();
 
 private:
@@ -1,46 +1,131 @@
 #include "TaskPool.h"
 
+#include <algorithm>
+
 namespace av {
-TaskPool::TaskPool() {
-    m_thread = std::thread([this]() { this->ThreadLoop(); });
+
+namespace {
+// 当前线程所属的线程池及工作线程下标，用于把工作线程内部提交的任务放入本地队列
+thread_local const TaskPool* t_currentPool = nullptr;
+thread_local size_t t_workerIndex = 0;
+}  // namespace
+
+TaskPool::TaskPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    // 所有队列创建完成后再启动线程，窃取时可以安全地遍历 m_workers
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers[i]->thread = std::thread([this, i]() { this->ThreadLoop(i); });
+    }
 }
 
 TaskPool::~TaskPool() {
     {
-        std::unique_lock<std::mutex> lock(m_taskMutex);
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
         m_stopFlag = true;
     }
-    m_taskCondition.notify_all();
-    if (m_thread.joinable()) {
-        m_thread.join();
+    m_sleepCondition.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
     }
 }
 
-void TaskPool::SubmitTask(std::function<void()> task) {
+void TaskPool::SubmitTask(std::function<void()> task, TaskPriority priority, int workerIndex) {
+    int level = static_cast<int>(priority);
+    bool pinned = workerIndex >= 0 && static_cast<size_t>(workerIndex) < m_workers.size();
+
+    if (pinned) {
+        auto& worker = *m_workers[workerIndex];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.pinnedTasks[level].push_back(std::move(task));
+        }
+        ++worker.pinnedCount;
+    } else {
+        // 工作线程内部提交的任务优先放入本线程队列，数据更可能还在缓存中
+        size_t index = t_currentPool == this ? t_workerIndex : m_nextWorker++ % m_workers.size();
+        auto& worker = *m_workers[index];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.tasks[level].push_back(std::move(task));
+        }
+        ++m_stealableCount;
+    }
+
     {
-        std::unique_lock<std::mutex> lock(m_taskMutex);
-        m_tasks.push(task);
+        // 加锁保证等待中的线程不会错过通知
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
     }
-    m_taskCondition.notify_one();
+    // 绑定线程的任务必须唤醒指定线程，只能广播
+    pinned ? m_sleepCondition.notify_all() : m_sleepCondition.notify_one();
 }
 
-void TaskPool::ThreadLoop() {
-    while (true) {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(m_taskMutex);
-            m_taskCondition.wait(lock, [this]() { return !m_tasks.empty() || m_stopFlag; });
+bool TaskPool::HasTask(size_t index) const {
+    return m_stealableCount > 0 || m_workers[index]->pinnedCount > 0;
+}
 
-            if (m_stopFlag && m_tasks.empty()) {
-                break;
+bool TaskPool::PopTask(size_t index, std::function<void()>& task) {
+    auto& self = *m_workers[index];
+    for (int level = kPriorityCount - 1; level >= 0; --level) {
+        {
+            std::lock_guard<std::mutex> lock(self.mutex);
+            auto& pinnedTasks = self.pinnedTasks[level];
+            if (!pinnedTasks.empty()) {
+                task = std::move(pinnedTasks.front());
+                pinnedTasks.pop_front();
+                --self.pinnedCount;
+                return true;
+            }
+            // 本线程从队尾取，窃取者从队头取，减少两者在同一端竞争
+            auto& tasks = self.tasks[level];
+            if (!tasks.empty()) {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                --m_stealableCount;
+                return true;
             }
+        }
 
-            task = m_tasks.front();
-            m_tasks.pop();
+        for (size_t offset = 1; offset < m_workers.size(); ++offset) {
+            auto& victim = *m_workers[(index + offset) % m_workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            auto& tasks = victim.tasks[level];
+            if (!tasks.empty()) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                --m_stealableCount;
+                return true;
+            }
         }
-        task();
     }
+    return false;
 }
 
+void TaskPool::ThreadLoop(size_t index) {
+    t_currentPool = this;
+    t_workerIndex = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (PopTask(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this, index]() { return HasTask(index) || m_stopFlag; });
+        // 退出前执行完已提交的任务
+        if (m_stopFlag && !HasTask(index)) {
+            break;
+        }
+    }
+
+    t_currentPool = nullptr;
+}
 
-}
\ No newline at end of file
+}  // namespace av
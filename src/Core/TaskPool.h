@@ -1,30 +1,78 @@
 #pragma once
 
-#include <functional>
-#include <thread>
+#include <atomic>
 #include <condition_variable>
-#include <queue>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
-#include <atomic>
-
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace av {
 
+// 任务优先级，数值越大越先执行
+enum class TaskPriority {
+    kLow = 0,
+    kNormal,
+    kHigh,
+};
+
+// 工作窃取线程池
+// 每个工作线程持有自己的任务队列，空闲时从其它线程的队列头部窃取任务；
+// 指定了 workerIndex 的任务只会在对应线程上执行，用于 OpenGL 上下文等与线程绑定的资源
 class TaskPool {
 public:
-    TaskPool();
+    // 不指定执行线程
+    static constexpr int kAnyWorker = -1;
+    // 约定承载 OpenGL 上下文的工作线程
+    static constexpr int kGLWorker = 0;
+
+    // threadCount 为 0 时按 CPU 核心数创建
+    explicit TaskPool(size_t threadCount = 0);
     ~TaskPool();
-    void SubmitTask(std::function<void()> task);
+
+    void SubmitTask(std::function<void()> task, TaskPriority priority = TaskPriority::kNormal,
+                    int workerIndex = kAnyWorker);
+
+    // 提交任务并通过 future 获取返回值或异常
+    template <typename Func>
+    auto Submit(Func&& func, TaskPriority priority = TaskPriority::kNormal, int workerIndex = kAnyWorker)
+        -> std::future<std::invoke_result_t<std::decay_t<Func>>> {
+        using Result = std::invoke_result_t<std::decay_t<Func>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+        auto future = task->get_future();
+        SubmitTask([task]() { (*task)(); }, priority, workerIndex);
+        return future;
+    }
+
+    size_t GetThreadCount() const { return m_workers.size(); }
 
 private:
-    void ThreadLoop();
+    static constexpr int kPriorityCount = 3;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> pinnedTasks[kPriorityCount];  // 只能由本线程执行
+        std::deque<std::function<void()>> tasks[kPriorityCount];        // 可被其它线程窃取
+        std::atomic<size_t> pinnedCount{0};
+        std::thread thread;
+    };
+
+    void ThreadLoop(size_t index);
+    bool PopTask(size_t index, std::function<void()>& task);
+    bool HasTask(size_t index) const;
 
 private:
-    std::thread m_thread;
-    std::queue<std::function<void()>> m_tasks;
-    std::condition_variable m_taskCondition;
-    std::mutex m_taskMutex;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_stealableCount{0};
+    std::atomic<size_t> m_nextWorker{0};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
     std::atomic<bool> m_stopFlag{false};
 };
 
-}
\ No newline at end of file
+}  // namespace av
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace av {
+
+// 解码线程模式
+enum class DecodeThreadingMode {
+    kAuto = 0,      // 帧级 + 片级，由解码器按码流能力选择
+    kFrame,         // 帧级多线程，吞吐量高，但会增加 threadCount 帧的延迟
+    kSlice,         // 片级多线程，无额外延迟，依赖码流按 slice 编码
+    kDisabled,      // 单线程解码
+};
+
+struct DecodeThreadingParameters {
+    DecodeThreadingMode mode{DecodeThreadingMode::kAuto};
+    int threadCount{0};     ///< 线程数，0 表示按 CPU 核心数自动选择
+};
+
+}  // namespace av
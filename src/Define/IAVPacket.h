@@ -18,6 +18,8 @@ struct IAVPacket {
     int flags{0};
     struct AVPacket* avPacket{nullptr};
     AVRational timeBase{AVRational{0, 0}};
+    // 仅刷新包使用：解码器丢弃 pts（流时间基）早于该值的帧，用于精确跳转
+    int64_t discardBeforePts{AV_NOPTS_VALUE};
     std::weak_ptr<std::function<void()>> releaseCallback;
 
     explicit IAVPacket(struct AVPacket* avPacket) : avPacket(avPacket) {}
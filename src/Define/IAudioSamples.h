@@ -19,6 +19,7 @@ struct IAudioSamples {
     int64_t duration;           // 持续时间
     int32_t timebaseNum;        // 时间基数分子
     int32_t timebaseDen;        // 时间基数分母
+    float playbackRate{1.0f};   // 倍速播放时经过变速处理的样本，每个样本代表该倍数的媒体时长
 
     std::vector<int16_t> pcmData;
     size_t offset{0};
@@ -27,7 +28,8 @@ struct IAudioSamples {
 
     // 获取时间戳
     float GetTimeStamp() const {
-        return pts * 1.0f * (timebaseNum / timebaseDen);
+        if (timebaseDen == 0) return 0.0f;
+        return static_cast<float>(static_cast<double>(pts) * timebaseNum / timebaseDen);
     }
 
     virtual ~IAudioSamples() {
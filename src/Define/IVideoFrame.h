@@ -3,8 +3,34 @@
 #include <cstdint>
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+struct AVFrame;
 
 namespace av {
+
+// 视频帧数据的像素格式
+enum class VideoPixelFormat {
+    kRGBA = 0,      // data 中为 RGBA 数据
+    kYUV420P,       // avFrame 中为 Y/U/V 三个平面
+    kNV12,          // avFrame 中为 Y 平面 + UV 交织平面
+};
+
+// 纹理的 GPU 完成标记，由渲染纹理的线程在提交绘制命令后创建
+// 使用者在真正采样纹理前等待，生产者无需阻塞到 GPU 完成
+struct IVideoFrameFence {
+    virtual ~IVideoFrameFence() = default;
+    // 让当前上下文之后的 GPU 命令等待纹理完成，不阻塞调用线程
+    virtual void WaitOnGPU() = 0;
+    // 阻塞调用线程直到纹理完成，超时返回 false
+    virtual bool WaitOnCPU(uint64_t timeoutNs) = 0;
+};
+
+// 各使用者采样纹理后插入的完成标记，纹理归还后再次写入前需等待它们
+using VideoFrameFences = std::vector<std::shared_ptr<IVideoFrameFence>>;
+
 // 封装和管理一个视频帧及其相关元数据
 struct IVideoFrame {
     int flags{0};
@@ -14,20 +40,52 @@ struct IVideoFrame {
     int64_t duration{0};
     int32_t timebaseNum{1};
     int32_t timebaseDen{1};
+    VideoPixelFormat format{VideoPixelFormat::kRGBA};
     std::shared_ptr<uint8_t> data;      // RGBA 数据
+    std::shared_ptr<AVFrame> avFrame;   // YUV 数据，直接引用解码器输出的帧，不做拷贝
 
     unsigned int textureId{0};          // OpenGL 纹理 ID
+    // 纹理首行为画面顶部（系统内存中的行序），与 OpenGL 纹理坐标相反；各阶段采样时翻转 y，不再单独绘制翻转
+    // 异步读回的使用者在发起拷贝时记下行序，不需要为此持有帧（纹理由 SetConsumerFence 保护）
+    bool textureFlipped{false};
+    std::shared_ptr<IVideoFrameFence> fence;  // textureId 的完成标记，为空表示纹理可以直接使用
 
     std::weak_ptr<std::function<void()>> releaseCallback;
+    // 帧释放时归还当前持有的纹理及使用者的完成标记，纹理来自纹理池时设置
+    std::function<void(unsigned int, VideoFrameFences)> textureReleaseCallback;
+
+    // 使用者（显示、编码）在自己的上下文中采样 textureId 后调用，记录其命令的完成标记
+    // 同一使用者只保留最新的标记，同一上下文中的命令按顺序完成
+    void SetConsumerFence(const void* consumer, std::shared_ptr<IVideoFrameFence> consumerFence) {
+        if (!consumerFence) return;
+        std::lock_guard<std::mutex> lock(m_consumerFenceMutex);
+        for (auto& entry : m_consumerFences) {
+            if (entry.first == consumer) {
+                entry.second = std::move(consumerFence);
+                return;
+            }
+        }
+        m_consumerFences.emplace_back(consumer, std::move(consumerFence));
+    }
 
     float GetTimeStamp() const {
-        return pts * 1.0f * timebaseNum * timebaseDen;
+        if (timebaseDen == 0) return 0.0f;
+        return static_cast<float>(static_cast<double>(pts) * timebaseNum / timebaseDen);
     }
     virtual ~IVideoFrame() {
+        if (textureId && textureReleaseCallback) {
+            VideoFrameFences consumerFences;
+            for (auto& entry : m_consumerFences) consumerFences.push_back(std::move(entry.second));
+            textureReleaseCallback(textureId, std::move(consumerFences));
+        }
         if (auto lockedPtr = releaseCallback.lock()) {
             (*lockedPtr)();
         }
     }
+
+private:
+    std::mutex m_consumerFenceMutex;
+    std::vector<std::pair<const void*, std::shared_ptr<IVideoFrameFence>>> m_consumerFences;
 };
 
 }
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace av {
+
+// 跳转模式
+enum class SeekMode {
+    kExact = 0,     // 精确跳转：从目标之前的关键帧解码，丢弃目标时间之前的帧
+    kFast,          // 快速跳转：直接定位到离目标最近的关键帧，适合拖动进度条
+};
+
+}  // namespace av
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace av {
+
+// 音画同步使用的主时钟
+enum class SyncClockType {
+    kAuto = 0,      // 有音频流时以音频为准，否则使用系统时钟
+    kAudio,         // 以音频设备实际播出的位置为准，视频追随音频
+    kVideo,         // 以视频时间戳为准，音频按视频节奏送出
+    kExternal,      // 以系统时钟为准，适合静音播放或无音频的文件
+    kUnpaced,       // 不按时间节奏，尽可能快地处理（批处理）
+};
+
+}  // namespace av
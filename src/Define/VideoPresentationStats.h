@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace av {
+
+// 视频帧按时钟送出的统计信息
+struct VideoPresentationStats {
+    uint64_t presentedFrames{0};    // 按时钟送出的视频帧数
+    uint64_t lateFrames{0};         // 送出时已落后超过同步阈值的帧数
+    uint64_t droppedFrames{0};      // 落后且下一帧也已到期、在送入视频管线前丢弃的帧数
+    uint64_t decimatedFrames{0};    // 倍速播放时超出显示帧率、抽掉不送出的帧数
+    uint64_t skippedFrames{0};      // 落后或高倍速时解码器跳过、没有输出的非参考帧数
+    double meanError{0.0};          // 送出时刻相对到期时刻的平均偏差（秒，正数表示晚于到期）
+    double jitter{0.0};             // 偏差的标准差（秒）
+    double maxError{0.0};           // 最大偏差（秒）
+};
+
+}  // namespace av
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace av {
+
+// 编码前从 OpenGL 纹理读回像素的阻塞统计
+// 同步读回在发起拷贝后要一直等到 GPU 完成；异步读回只在映射时等待尚未完成的拷贝，两者之差即省下的阻塞时间
+struct VideoReadbackStats {
+    uint64_t readbackCount{0};          // 读回的帧数
+    uint64_t stalledCount{0};           // 映射时拷贝尚未完成、仍需等待的帧数
+    double synchronousStallMs{0.0};     // 同步读回需要的阻塞总时间：从发起拷贝到 GPU 完成拷贝
+    double asynchronousStallMs{0.0};    // 异步读回映射时实际等待的总时间
+};
+
+}  // namespace av
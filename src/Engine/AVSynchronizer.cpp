@@ -1,8 +1,13 @@
 #include "AVSynchronizer.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace av {
 
-AVSynchronizer::AVSynchronizer(GLContext& glContext) : m_glContext(glContext) {
+AVSynchronizer::AVSynchronizer() {
+    // 未接入音频设备时退回到最近送出的音频时间戳
+    m_masterClock = IMasterClock::Create(SyncClockType::kAudio);
     Start();
 }
 
@@ -14,6 +19,24 @@ void AVSynchronizer::SetListener(Listener* listener) {
     m_listener = listener;
 }
 
+void AVSynchronizer::SetMasterClock(std::shared_ptr<IMasterClock> masterClock) {
+    {
+        std::lock_guard<std::mutex> lock(m_masterClockMutex);
+        m_masterClock = std::move(masterClock);
+    }
+    m_notifier.Notify();
+}
+
+std::shared_ptr<IMasterClock> AVSynchronizer::GetMasterClock() {
+    std::lock_guard<std::mutex> lock(m_masterClockMutex);
+    return m_masterClock;
+}
+
+void AVSynchronizer::SetPlaybackRate(double rate) {
+    m_playbackRate = rate;
+    m_notifier.Notify();
+}
+
 void AVSynchronizer::Start() {
     m_abort = false;
     // m_audioStreamInfo.Reset();
@@ -26,6 +49,8 @@ void AVSynchronizer::Start() {
 void AVSynchronizer::Stop() {
     m_abort = true;
     m_notifier.Notify();
+    m_audioQueue.WakeProducer();
+    m_videoQueue.WakeProducer();
     if (m_syncThread.joinable()) m_syncThread.join();
 }
 
@@ -34,48 +59,89 @@ void AVSynchronizer::Reset() {
     m_notifier.Notify();
 }
 
+namespace {
+
+// 按刷新标记丢弃数据：存在未处理的刷新标记时，丢弃刷新标记及其之前的数据
+template <typename T>
+void DiscardUntilFlush(SPSCQueue<std::shared_ptr<T>>& queue, std::atomic<int>& pendingFlushCount) {
+    while (pendingFlushCount > 0) {
+        auto front = queue.Front();
+        if (!front) return;
+        bool isFlush = (*front)->flags & static_cast<int>(AVFrameFlag::kFlush);
+        queue.Pop();
+        if (isFlush) pendingFlushCount--;
+    }
+}
+
+template <typename T>
+void DiscardAll(SPSCQueue<std::shared_ptr<T>>& queue, std::atomic<int>& pendingFlushCount) {
+    std::shared_ptr<T> item;
+    while (queue.TryPop(item)) {
+        if (item->flags & static_cast<int>(AVFrameFlag::kFlush)) pendingFlushCount--;
+    }
+}
+
+// 刷新标记先计数再入队，保证消费者看到刷新标记时计数已生效；
+// 队列满时解码线程等待同步线程（反压），只有停止时放弃
+template <typename T>
+void PushItem(SPSCQueue<std::shared_ptr<T>>& queue, std::atomic<int>& pendingFlushCount, std::shared_ptr<T> item,
+              const std::atomic<bool>& abort) {
+    bool isFlush = item->flags & static_cast<int>(AVFrameFlag::kFlush);
+    if (isFlush) pendingFlushCount++;
+    if (!queue.Push(std::move(item), [&abort]() { return abort.load(); })) {
+        if (isFlush) pendingFlushCount--;
+    }
+}
+
+}  // namespace
+
+void AVSynchronizer::DiscardFlushedItems() {
+    DiscardUntilFlush(m_audioQueue, m_pendingAudioFlushCount);
+    DiscardUntilFlush(m_videoQueue, m_pendingVideoFlushCount);
+}
+
+void AVSynchronizer::DiscardAllItems() {
+    DiscardAll(m_audioQueue, m_pendingAudioFlushCount);
+    DiscardAll(m_videoQueue, m_pendingVideoFlushCount);
+}
+
 void AVSynchronizer::ThreadLoop() {
+    auto dueTime = Clock::time_point::max();
     while (true) {
-        m_notifier.Wait(100);
+        // 音视频数据到达、重置、停止、切换时钟都会唤醒线程；
+        // 有数据未到期时按主时钟计算的到期时刻定时等待，不轮询
+        if (dueTime == Clock::time_point::max()) {
+            m_notifier.Wait();
+        } else {
+            m_notifier.WaitUntil(dueTime);
+        }
         if (m_abort) {
             break;
         }
         if (m_reset) {
-            m_audioQueue.clear();
-            m_videoQueue.clear();
+            DiscardAllItems();
+            if (auto masterClock = GetMasterClock()) masterClock->Reset();
+            // 跳转后重新评估负载
+            m_averageLateness = 0.0;
+            m_consecutiveDrops = 0;
+            m_lastPresentedTimeStamp = -1.0;
+            SetVideoLagging(false);
             m_reset = false;
         }
-        Synchronize();
-    }
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_videoQueue.clear();
+        dueTime = Synchronize();
     }
+    DiscardAllItems();
 }
 
 void AVSynchronizer::NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
     if (!audioSamples) return;
-
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (audioSamples->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-            m_audioQueue.clear();
-        }
-        m_audioQueue.push_back(audioSamples);
-    }
+    PushItem(m_audioQueue, m_pendingAudioFlushCount, audioSamples, m_abort);
     m_notifier.Notify();
 }
 
 void AVSynchronizer::NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
     if (!videoFrame) return;
-
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (videoFrame->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-            m_videoQueue.clear();
-        }
-        m_videoQueue.push_back(videoFrame);
-    }
+    PushItem(m_videoQueue, m_pendingVideoFlushCount, videoFrame, m_abort);
     m_notifier.Notify();
 }
 
@@ -92,26 +158,120 @@ void AVSynchronizer::NotifyVideoFinished() {
 }
 
 
-void AVSynchronizer::Synchronize() {
-    std::unique_lock<std::mutex> lock(m_mutex);
+VideoPresentationStats AVSynchronizer::GetPresentationStats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_presentationStats;
+}
 
-    while (!m_audioQueue.empty()) {
-        auto audioSamples = m_audioQueue.front();
+void AVSynchronizer::RecordPresentation(double error) {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    auto& stats = m_presentationStats;
+    stats.presentedFrames++;
+    if (error > syncThreshold) stats.lateFrames++;
+    // 增量计算均值与方差，不保存历史数据
+    double delta = error - stats.meanError;
+    stats.meanError += delta / static_cast<double>(stats.presentedFrames);
+    m_errorSquareSum += delta * (error - stats.meanError);
+    stats.jitter = std::sqrt(m_errorSquareSum / static_cast<double>(stats.presentedFrames));
+    stats.maxError = std::max(stats.maxError, error);
+}
+
+bool AVSynchronizer::ShouldDropLateFrame(double clockTime) {
+    if (m_consecutiveDrops >= kMaxConsecutiveDrops) return false;
+    auto next = m_videoQueue.Front();
+    if (!next) return false;
+    int markers = static_cast<int>(AVFrameFlag::kEOS) | static_cast<int>(AVFrameFlag::kFlush);
+    return !((*next)->flags & markers) && (*next)->GetTimeStamp() <= clockTime;
+}
+
+bool AVSynchronizer::ShouldDecimateFrame(double timeStamp, double rate) {
+    if (rate <= 1.0 || m_lastPresentedTimeStamp < 0) return false;
+    double interval = (timeStamp - m_lastPresentedTimeStamp) / rate;
+    if (interval < 0 || interval >= kMinPresentInterval) return false;
+    auto next = m_videoQueue.Front();
+    if (!next) return false;
+    int markers = static_cast<int>(AVFrameFlag::kEOS) | static_cast<int>(AVFrameFlag::kFlush);
+    return !((*next)->flags & markers);
+}
+
+void AVSynchronizer::UpdateLagState(double error) {
+    constexpr double kSmoothing = 0.1;
+    m_averageLateness += (error - m_averageLateness) * kSmoothing;
+
+    auto now = Clock::now();
+    bool changing = m_videoLagging ? m_averageLateness < syncThreshold / 2 : m_averageLateness > syncThreshold;
+    if (!changing) {
+        m_lagStateChangeTime = Clock::time_point::max();
+        return;
+    }
+    if (m_lagStateChangeTime == Clock::time_point::max()) m_lagStateChangeTime = now;
+    if (now - m_lagStateChangeTime >= (m_videoLagging ? kLagLeaveDuration : kLagEnterDuration)) {
+        SetVideoLagging(!m_videoLagging);
+    }
+}
+
+void AVSynchronizer::SetVideoLagging(bool lagging) {
+    m_lagStateChangeTime = Clock::time_point::max();
+    if (m_videoLagging == lagging) return;
+    m_videoLagging = lagging;
+    std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
+    if (m_listener) {
+        m_listener->OnAVSynchronizerNotifyVideoLagging(lagging);
+    }
+}
+
+namespace {
+
+// 时钟上的时长换算为稳定时钟上的到期时刻，单次等待不超过 maxWaitTime
+AVSynchronizer::Clock::time_point ToDueTime(double seconds, AVSynchronizer::Clock::time_point now,
+                                            std::chrono::milliseconds maxWaitTime) {
+    auto wait = std::chrono::duration_cast<AVSynchronizer::Clock::duration>(
+        std::chrono::duration<double>(std::max(seconds, 0.0)));
+    return now + std::min<AVSynchronizer::Clock::duration>(wait, maxWaitTime);
+}
+
+}  // namespace
+
+AVSynchronizer::Clock::time_point AVSynchronizer::Synchronize() {
+    DiscardFlushedItems();
+
+    auto dueTime = Clock::time_point::max();
+    auto masterClock = GetMasterClock();
+    if (!masterClock) return dueTime;
+    // 时钟按倍速推进，时钟上的时长除以倍速才是实际等待时长
+    double rate = m_playbackRate;
+    if (masterClock->GetRate() != rate) masterClock->SetRate(rate);
+
+    while (auto front = m_audioQueue.Front()) {
+        auto audioSamples = *front;
         // 当音频帧处理完毕，表示处理结束
         if (audioSamples->flags & static_cast<int>(AVFrameFlag::kEOS)) {
+            m_audioQueue.Pop();
             m_audioStreamInfo.isFinished = true;
-            m_audioQueue.pop_front();
+            masterClock->OnAudioFinished();
             std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
             if (m_listener) {
                 m_listener->OnAVSynchronizerNotifyAudioFinished();
             } 
         } else if (audioSamples->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-            m_audioQueue.clear();
-            m_videoQueue.clear();
+            m_audioQueue.Pop();
+            m_pendingAudioFlushCount--;
+            m_audioStreamInfo.Reset();
+            masterClock->Reset();
         } else {
+            // 主时钟不是音频时，音频也按时钟节奏送出，只提前一小段填充扬声器缓冲
+            if (masterClock->IsPaced() && masterClock->PacesAudio()) {
+                double clockTime = masterClock->GetTime();
+                double timeDiff = audioSamples->GetTimeStamp() - kAudioLeadTime * rate - clockTime;
+                if (clockTime >= 0 && timeDiff > 0) {
+                    dueTime = std::min(dueTime, ToDueTime(timeDiff / rate, Clock::now(), kMaxWaitTime));
+                    break;
+                }
+            }
             // 处理音频，即直接发送给播放器进行播放
+            m_audioQueue.Pop();
             m_audioStreamInfo.currentTimeStamp = audioSamples->GetTimeStamp();
-            m_audioQueue.pop_front();
+            masterClock->OnAudioDispatched(m_audioStreamInfo.currentTimeStamp);
             std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
             if (m_listener) {
                 m_listener->OnAVSynchronizerNotifyAudioSamples(audioSamples);
@@ -119,48 +279,71 @@ void AVSynchronizer::Synchronize() {
         }
     }
 
-    while (!m_videoQueue.empty()) {
-        auto videoFrame = m_videoQueue.front();
+    while (auto front = m_videoQueue.Front()) {
+        auto videoFrame = *front;
         if (videoFrame->flags & static_cast<int>(AVFrameFlag::kEOS)) {
             m_videoStreamInfo.isFinished = true;
-            m_videoQueue.pop_front();
+            m_videoQueue.Pop();
             std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
             if (m_listener) {
                 m_listener->OnAVSynchronizerNotifyVideoFinished();
             }
             continue;
         } else if (videoFrame->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-            m_audioQueue.clear();
-            m_videoQueue.clear();
+            m_videoQueue.Pop();
+            m_pendingVideoFlushCount--;
+            m_videoStreamInfo.Reset();
+            masterClock->Reset();
+            m_averageLateness = 0.0;
+            m_consecutiveDrops = 0;
+            m_lastPresentedTimeStamp = -1.0;
+            SetVideoLagging(false);
             continue;
         }
-        // 视频帧处理，三种情况：
-        // 1. 视频落后太多，丢弃该帧
-        // 2. 视频超前太多，停止处理
-        // 3. 交给播放器进行播放
-        auto timeDiff = m_audioStreamInfo.currentTimeStamp - videoFrame->GetTimeStamp();
-        if (timeDiff > syncThreshold) {
-            m_videoStreamInfo.currentTimeStamp = videoFrame->GetTimeStamp();
-            m_videoQueue.pop_front();
-            std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
-            if (m_listener) {
-                m_listener->OnAVSynchronizerNotifyVideoFrame(videoFrame);
-            } 
-            // 处理下一帧
-            continue;
-        } else if (timeDiff < -syncThreshold) {
-            // 视频超前，不处理视频，直接跳过
+
+        auto now = Clock::now();
+        double clockTime = masterClock->GetTime();
+        if (masterClock->IsPaced() && clockTime < 0 && !masterClock->CanStartWithVideo()) {
+            // 等待音频开始计时，音频到达会唤醒同步线程
             break;
-        } else {
-            m_videoStreamInfo.currentTimeStamp = videoFrame->GetTimeStamp();
-            m_videoQueue.pop_front();
-            std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
-            if (m_listener) {
-                m_listener->OnAVSynchronizerNotifyVideoFrame(videoFrame);
-            }
-            // 处理结束
+        }
+        // 视频帧处理：
+        // 1. 不限速或时钟尚未开始，直接送出（并开始计时）
+        // 2. 尚未到期，精确等待到它的时间戳
+        // 3. 已到期（含落后），送出后继续检查下一帧
+        bool paced = masterClock->IsPaced() && clockTime >= 0;
+        double timeDiff = clockTime - videoFrame->GetTimeStamp();
+        if (paced && timeDiff < -kPresentTolerance) {
+            // 时钟按倍速推进，到期时刻即当前时刻加上差值除以倍速
+            dueTime = std::min(dueTime, ToDueTime(-timeDiff / rate, now, kMaxWaitTime));
             break;
         }
+        m_videoStreamInfo.currentTimeStamp = videoFrame->GetTimeStamp();
+        m_videoQueue.Pop();
+        if (paced && ShouldDecimateFrame(m_videoStreamInfo.currentTimeStamp, rate)) {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_presentationStats.decimatedFrames++;
+            continue;
+        }
+        if (paced && timeDiff > syncThreshold && ShouldDropLateFrame(clockTime)) {
+            // 在上传和滤镜之前丢弃，过载时不再为注定过期的帧消耗 GPU；帧释放后解码器资源随即归还
+            m_consecutiveDrops++;
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_presentationStats.droppedFrames++;
+            continue;
+        }
+        if (paced) {
+            RecordPresentation(timeDiff);
+            UpdateLagState(timeDiff);
+        }
+        m_consecutiveDrops = 0;
+        m_lastPresentedTimeStamp = m_videoStreamInfo.currentTimeStamp;
+        masterClock->OnVideoDispatched(m_videoStreamInfo.currentTimeStamp);
+        std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
+        if (m_listener) {
+            m_listener->OnAVSynchronizerNotifyVideoFrame(videoFrame);
+        }
     }
+    return dueTime;
+}
 }
-}
\ No newline at end of file
@@ -1,32 +1,48 @@
 #pragma once
 
-#include "Utils/GLUtils.h"
 #include "Define/IAudioSamples.h"
 #include "Define/IVideoFrame.h"
 #include "Core/SyncNotifier.h"
+#include "Core/SPSCQueue.h"
 #include "Define/BaseDef.h"
+#include "Define/VideoPresentationStats.h"
+#include "MasterClock.h"
 
 #include <mutex>
 #include <list>
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 
 namespace av {
 
 class AVSynchronizer {
 public:
+    using Clock = std::chrono::steady_clock;
+
     struct Listener {
         virtual void OnAVSynchronizerNotifyAudioSamples(std::shared_ptr<IAudioSamples>) = 0;
         virtual void OnAVSynchronizerNotifyVideoFrame(std::shared_ptr<IVideoFrame>) = 0;
         virtual void OnAVSynchronizerNotifyAudioFinished() = 0;
         virtual void OnAVSynchronizerNotifyVideoFinished() = 0;
+        // 视频持续落后/恢复正常，落后期间解码器可以跳过非参考帧降低负载
+        virtual void OnAVSynchronizerNotifyVideoLagging(bool lagging) {}
         virtual ~Listener() = default;
     };
 
     void SetListener(Listener* listener);
-    // AVSynchronizer();
-    explicit AVSynchronizer(GLContext& glContext);
+    // 设置主时钟，可在播放过程中切换，新时钟从下一份送出的数据开始计时
+    void SetMasterClock(std::shared_ptr<IMasterClock> masterClock);
+    std::shared_ptr<IMasterClock> GetMasterClock();
+    // 播放倍速，主时钟按该倍速推进；倍速大于 1 时抽帧，小于 1 时画面停留在上一帧直到下一帧到期
+    void SetPlaybackRate(double rate);
+    double GetPlaybackRate() const { return m_playbackRate; }
+
+    VideoPresentationStats GetPresentationStats();
+    AVSynchronizer();
     ~AVSynchronizer();
 
     // 并发控制
@@ -41,10 +57,23 @@ public:
     void NotifyVideoFinished();
 
 private:
-    // 以音频为基准进行同步
-    void Synchronize();
+    // 按主时钟送出到期的音视频数据，返回下一份数据的到期时刻，Clock::time_point::max() 表示等待新数据
+    Clock::time_point Synchronize();
+    // 记录一帧视频送出时相对到期时刻的偏差
+    void RecordPresentation(double error);
+    // 落后的帧在下一帧也已到期时丢弃，连续丢弃有上限，保证画面仍在更新
+    bool ShouldDropLateFrame(double clockTime);
+    // 倍速播放时相邻送出帧的实际间隔短于显示刷新间隔，且后面还有帧可以接替时抽掉该帧
+    bool ShouldDecimateFrame(double timeStamp, double rate);
+    // 根据送出帧的平均落后程度判断是否持续落后，状态变化时通知监听器
+    void UpdateLagState(double error);
+    void SetVideoLagging(bool lagging);
 
     void ThreadLoop();
+    // 丢弃队列中最后一个刷新标记及其之前的数据，只能在同步线程调用
+    void DiscardFlushedItems();
+    // 丢弃队列中所有数据，只能在同步线程调用
+    void DiscardAllItems();
 private:
     // 处理音频/视频流的结构体
     struct StreamInfo {
@@ -59,13 +88,42 @@ private:
     StreamInfo m_videoStreamInfo;
 
     const double syncThreshold = 0.05;
-
-    // OpenGL context
-    GLContext m_glContext;
-
-    std::mutex m_mutex;
-    std::list<std::shared_ptr<IAudioSamples>> m_audioQueue;
-    std::list<std::shared_ptr<IVideoFrame>> m_videoQueue;
+    // 主时钟不是音频时，音频提前于时钟送出的时长，用于填充扬声器缓冲
+    static constexpr double kAudioLeadTime = 0.2;
+    // 单次定时等待的上限，时钟被重新锚定后也能及时重新计算
+    static constexpr std::chrono::milliseconds kMaxWaitTime{100};
+    // 视频帧允许提前送出的时长，吸收定时器唤醒与时钟读数的误差，避免为亚毫秒的差值再次等待
+    static constexpr double kPresentTolerance = 0.001;
+    // 倍速播放时送出视频帧的最小实际间隔，超过显示刷新率的帧看不到，只会占用视频管线
+    static constexpr double kMinPresentInterval = 1.0 / 60.0;
+
+    std::atomic<double> m_playbackRate{1.0};
+
+    std::mutex m_masterClockMutex;
+    std::shared_ptr<IMasterClock> m_masterClock;
+
+    // 解码线程 -> 同步线程，队列长度受解码器资源计数限制，满时解码线程等待
+    static constexpr size_t kQueueCapacity = 64;
+    SPSCQueue<std::shared_ptr<IAudioSamples>> m_audioQueue{kQueueCapacity};
+    SPSCQueue<std::shared_ptr<IVideoFrame>> m_videoQueue{kQueueCapacity};
+    std::atomic<int> m_pendingAudioFlushCount{0};
+    std::atomic<int> m_pendingVideoFlushCount{0};
+
+    // 偏差统计，同步线程写、任意线程读
+    std::mutex m_statsMutex;
+    VideoPresentationStats m_presentationStats;
+    double m_errorSquareSum{0.0};   // 偏差与均值之差的平方和（Welford 算法）
+
+    // 丢帧与落后检测，只在同步线程访问
+    static constexpr int kMaxConsecutiveDrops = 4;
+    // 平均落后超过同步阈值持续该时长视为持续落后，低于阈值一半持续恢复时长后恢复
+    static constexpr std::chrono::milliseconds kLagEnterDuration{1000};
+    static constexpr std::chrono::milliseconds kLagLeaveDuration{2000};
+    int m_consecutiveDrops{0};
+    double m_lastPresentedTimeStamp{-1.0};
+    double m_averageLateness{0.0};
+    bool m_videoLagging{false};
+    Clock::time_point m_lagStateChangeTime{Clock::time_point::max()};
 
     std::mutex m_listenerMutex;
     Listener* m_listener{nullptr};
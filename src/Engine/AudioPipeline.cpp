@@ -1,5 +1,8 @@
 #include "AudioPipeline.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace av {
 
 IAudioPipeline* IAudioPipeline::Create(unsigned int channels, unsigned int sampleRate) {
@@ -8,7 +11,7 @@ IAudioPipeline* IAudioPipeline::Create(unsigned int channels, unsigned int sampl
 
 
 AudioPipeline::AudioPipeline(unsigned int channels, unsigned int sampleRate)
-    : m_channels(channels), m_sampleRate(sampleRate) {}
+    : m_channels(channels), m_sampleRate(sampleRate), m_timeStretcher(channels, sampleRate) {}
 
 void AudioPipeline::SetListener(Listener* listener) {
     std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
@@ -16,13 +19,63 @@ void AudioPipeline::SetListener(Listener* listener) {
 }
 
 
+void AudioPipeline::SetPlaybackRate(float rate) { m_playbackRate = rate; }
+
 void AudioPipeline::NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
+    float rate = m_playbackRate;
+    if (rate != 1.0f) {
+        // 原样本的数据已拷入变速器，替换后即释放；解码器资源随输出的样本一起交给扬声器，播放速度仍然约束解码
+        audioSamples = StretchAudioSamples(audioSamples, rate);
+        if (!audioSamples) return;
+    } else if (!m_timeStretcher.IsEmpty()) {
+        // 恢复原速，丢弃变速器中残留的几十毫秒数据
+        m_timeStretcher.Reset();
+    }
+
     std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
     if (m_listener) {
         m_listener->OnAudioPipelineNotifyAudioSamples(audioSamples);
     }
 }
 
+std::shared_ptr<IAudioSamples> AudioPipeline::StretchAudioSamples(const std::shared_ptr<IAudioSamples>& audioSamples,
+                                                                  float rate) {
+    // 输入不连续（跳转）超过该值时丢弃缓存的数据，重新开始
+    constexpr double kDiscontinuityThreshold = 0.1;
+    // 变速器只处理管线约定的格式
+    if (!audioSamples || audioSamples->channels != m_channels || audioSamples->sampleRate != m_sampleRate) {
+        return audioSamples;
+    }
+
+    size_t offset = std::min(audioSamples->offset, audioSamples->pcmData.size());
+    size_t frameCount = (audioSamples->pcmData.size() - offset) / m_channels;
+    double timeStamp = audioSamples->GetTimeStamp() + static_cast<double>(offset / m_channels) / m_sampleRate;
+    if (!m_timeStretcher.IsEmpty() &&
+        std::abs(timeStamp - m_timeStretcher.GetExpectedTimeStamp()) > kDiscontinuityThreshold) {
+        m_timeStretcher.Reset();
+    }
+    m_timeStretcher.SetRate(rate);
+
+    auto stretched = std::make_shared<IAudioSamples>();
+    double outputTimeStamp = 0.0;
+    if (!m_timeStretcher.Process(audioSamples->pcmData.data() + offset, frameCount, timeStamp, stretched->pcmData,
+                                 outputTimeStamp)) {
+        return nullptr;
+    }
+    stretched->flags = audioSamples->flags;
+    stretched->channels = m_channels;
+    stretched->sampleRate = m_sampleRate;
+    stretched->timebaseNum = 1;
+    stretched->timebaseDen = 1000000;
+    stretched->pts = std::llround(outputTimeStamp * 1000000.0);
+    stretched->duration = static_cast<int64_t>(stretched->pcmData.size() / m_channels) * 1000000 / m_sampleRate;
+    stretched->playbackRate = rate;
+    // 资源计数转移到输出样本，避免在同一个样本上归还两次
+    stretched->releaseCallback = audioSamples->releaseCallback;
+    audioSamples->releaseCallback.reset();
+    return stretched;
+}
+
 void AudioPipeline::NotifyAudioFinished() {
     std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
     if (m_listener) {
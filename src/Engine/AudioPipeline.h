@@ -1,5 +1,7 @@
 #pragma once
 #include "Interface/IAudioPipeline.h"
+#include "AudioTimeStretcher.h"
+#include <atomic>
 #include <mutex>
 
 namespace av {
@@ -12,11 +14,20 @@ public:
     void SetListener(Listener* listener) override;
     void NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) override;
     void NotifyAudioFinished() override;
+    void SetPlaybackRate(float rate) override;
+
+private:
+    // 倍速播放：变速不变调，输出的时间戳为首个样本对应的媒体时间；数据不足时返回空
+    std::shared_ptr<IAudioSamples> StretchAudioSamples(const std::shared_ptr<IAudioSamples>& audioSamples, float rate);
 
 private:
     unsigned int m_channels{2};
     unsigned int m_sampleRate{44100};
 
+    std::atomic<float> m_playbackRate{1.0f};
+    // 只在 NotifyAudioSamples 调用线程（同步线程）使用
+    AudioTimeStretcher m_timeStretcher;
+
     IAudioPipeline::Listener* m_listener{nullptr};
     std::recursive_mutex m_listenerMutex;
 };
@@ -1,5 +1,7 @@
 #include "AudioSpeaker.h"
 
+#include <algorithm>
+#include <chrono>
 
 namespace av {
 
@@ -7,7 +9,8 @@ IAudioSpeaker *IAudioSpeaker::Create(unsigned int channels, unsigned int sampleR
     return new AudioSpeaker(channels, sampleRate);
 }
 
-AudioSpeaker::AudioSpeaker(unsigned int channels, unsigned int sampleRate) {
+AudioSpeaker::AudioSpeaker(unsigned int channels, unsigned int sampleRate)
+    : m_pcmBuffer(static_cast<size_t>(channels) * sampleRate / 10), m_channels(channels), m_sampleRate(sampleRate) {
     // 获取默认输出设备
     m_outputDevices = new QMediaDevices(nullptr);
     outputDevice = m_outputDevices->defaultAudioOutput();
@@ -22,9 +25,15 @@ AudioSpeaker::AudioSpeaker(unsigned int channels, unsigned int sampleRate) {
     m_audioSinkOutput->setBufferSize(16 * 1024);
     open(QIODevice::ReadOnly);
     m_audioSinkOutput->start(this);
+
+    m_writerThread = std::thread(&AudioSpeaker::WriterLoop, this);
 }
 
 AudioSpeaker::~AudioSpeaker() {
+    m_abort = true;
+    m_writerNotifier.Notify();
+    m_pendingSamples.WakeProducer();
+    if (m_writerThread.joinable()) m_writerThread.join();
     close();
     m_audioSinkOutput->stop();
 }
@@ -33,31 +42,131 @@ void AudioSpeaker::PlayAudioSamples(std::shared_ptr<IAudioSamples> audioSamples)
     if (!audioSamples) {
         return;
     }
-    std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
-    m_audioSampleList.push_back(audioSamples);
+    m_pendingSamples.Push({std::move(audioSamples), m_stopGeneration}, [this]() { return m_abort.load(); });
+    m_writerNotifier.Notify();
 }
 
 void AudioSpeaker::Stop() {
-    std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
-    m_audioSampleList.clear();
+    m_flushPosition = m_pcmBuffer.WritePosition();
+    m_stopGeneration++;
+    m_writerNotifier.Notify();
 }
 
-qint64 AudioSpeaker::readData(char *data, qint64 maxlen) {
-    // 当前音频数据为空或者播放完毕，则取出下一个音频数据进行播放
-    if (m_audioSamples.pcmData.empty() || m_audioSamples.offset >= m_audioSamples.pcmData.size()) {
-        std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
-        if (m_audioSampleList.empty()) {
-            return 0;
+void AudioSpeaker::WriterLoop() {
+    while (!m_abort) {
+        PendingSamples pending;
+        if (!m_pendingSamples.TryPop(pending)) {
+            m_writerNotifier.Wait();
+            continue;
+        }
+        if (pending.generation != m_stopGeneration) continue;
+        WriteAudioSamples(pending.audioSamples, pending.generation);
+    }
+    m_pendingSamples.Clear();
+}
+
+void AudioSpeaker::WriteAudioSamples(const std::shared_ptr<IAudioSamples>& audioSamples, uint64_t generation) {
+    const int16_t* samples = audioSamples->pcmData.data() + audioSamples->offset;
+    size_t remaining = audioSamples->pcmData.size() - std::min(audioSamples->offset, audioSamples->pcmData.size());
+    // 队列满时丢弃标记，播放时钟按上一个标记连续外推
+    double rate = audioSamples->playbackRate;
+    m_timeStampMarks.TryPush({m_pcmBuffer.WritePosition(),
+                              audioSamples->GetTimeStamp() + static_cast<double>(audioSamples->offset) /
+                                                                 (static_cast<double>(m_channels) * m_sampleRate) * rate,
+                              rate});
+    while (remaining > 0) {
+        size_t written = m_pcmBuffer.Write(samples, remaining);
+        samples += written;
+        remaining -= written;
+        if (remaining == 0) break;
+        // 缓冲区满：等待设备回调腾出空间。样本在写完之前不释放，解码器的资源计数仍然起到反压作用
+        if (m_abort || m_stopGeneration != generation) return;
+        m_writerWaitingForSpace.store(true, std::memory_order_relaxed);
+        // 与 readData 中的栅栏配对：要么回调看到等待标志，要么这里看到腾出的空间
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_pcmBuffer.Size() == m_pcmBuffer.Capacity()) {
+            // 设备停止回调（例如输出设备被移除）时超时后重新检查，不会永久挂起
+            m_writerNotifier.Wait(100);
         }
-        m_audioSamples = *m_audioSampleList.front();
-        m_audioSampleList.pop_front();
+        m_writerWaitingForSpace.store(false, std::memory_order_relaxed);
+    }
+}
+
+qint64 AudioSpeaker::readData(char *data, qint64 maxlen) {
+    // 设备回调线程：丢弃 Stop 之前写入的样本，之后只拷贝本次输出的数据
+    size_t flushPosition = m_flushPosition;
+    m_pcmBuffer.DiscardUntil(flushPosition);
+    size_t samplesRead = m_pcmBuffer.Read(data, static_cast<size_t>(maxlen) / sizeof(int16_t));
+    UpdatePlaybackClock(flushPosition, samplesRead);
+    // 只有写入线程在等待空间时才唤醒，稳态下每次回调最多一次通知
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (samplesRead > 0 && m_writerWaitingForSpace.load(std::memory_order_relaxed)) m_writerNotifier.Notify();
+    return static_cast<qint64>(samplesRead * sizeof(int16_t));
+}
+
+double AudioSpeaker::GetPlaybackTimeStamp() {
+    double timeStamp = -1.0;
+    double maxAdvance = 0.0;
+    double rate = 1.0;
+    int64_t updateTime = 0;
+    uint32_t sequence = 0;
+    do {
+        sequence = m_clockSequence.load(std::memory_order_acquire);
+        if (sequence & 1) continue;
+        timeStamp = m_clockTimeStamp.load(std::memory_order_relaxed);
+        maxAdvance = m_clockMaxAdvance.load(std::memory_order_relaxed);
+        rate = m_clockRate.load(std::memory_order_relaxed);
+        updateTime = m_clockUpdateTime.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || sequence != m_clockSequence.load(std::memory_order_relaxed));
+    if (timeStamp < 0) return -1.0;
+
+    // 两次回调之间设备持续播出，按流逝时间外推，但不超过设备中剩余的数据
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    double elapsed = std::chrono::duration<double>(now - std::chrono::nanoseconds(updateTime)).count();
+    return timeStamp + std::clamp(elapsed * rate, 0.0, maxAdvance);
+}
+
+void AudioSpeaker::UpdatePlaybackClock(size_t flushPosition, size_t samplesRead) {
+    // 已交给设备但尚未播出的样本：设备缓冲中的数据，以及本次回调刚刚读出的数据
+    qsizetype sinkQueuedBytes = m_audioSinkOutput->bufferSize() - m_audioSinkOutput->bytesFree();
+    size_t queuedSamples = static_cast<size_t>(std::max<qsizetype>(sinkQueuedBytes, 0)) / sizeof(int16_t) + samplesRead;
+    size_t readPosition = m_pcmBuffer.ReadPosition();
+    double samplesPerSecond = static_cast<double>(m_channels) * m_sampleRate;
+
+    // 当前播出位置
+    size_t playedPosition = readPosition - std::min(queuedSamples, readPosition);
+    // Stop 之前的数据仍在设备中播出，此时没有可用的时钟
+    if (static_cast<std::ptrdiff_t>(playedPosition - flushPosition) < 0) {
+        PublishPlaybackClock(-1.0, 0.0, 1.0);
+        return;
     }
 
-    size_t bytesToRead = std::min(static_cast<size_t>(maxlen), (m_audioSamples.pcmData.size() - m_audioSamples.offset) * sizeof(int16_t));
-    // 将播放音频拷贝到 data
-    std::memcpy(data, m_audioSamples.pcmData.data() + m_audioSamples.offset, bytesToRead);
-    m_audioSamples.offset += bytesToRead / sizeof(int16_t);
-    return bytesToRead;
+    while (auto mark = m_timeStampMarks.Front()) {
+        if (static_cast<std::ptrdiff_t>(mark->position - playedPosition) > 0) break;
+        m_currentMark = *mark;
+        m_timeStampMarks.Pop();
+    }
+    if (m_currentMark.timeStamp < 0) {
+        PublishPlaybackClock(-1.0, 0.0, 1.0);
+        return;
+    }
+    // 变速后的每个样本代表 rate 倍的媒体时长
+    double rate = m_currentMark.rate;
+    PublishPlaybackClock(m_currentMark.timeStamp + (playedPosition - m_currentMark.position) / samplesPerSecond * rate,
+                         queuedSamples / samplesPerSecond * rate, rate);
+}
+
+void AudioSpeaker::PublishPlaybackClock(double timeStamp, double maxAdvance, double rate) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    m_clockSequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_clockTimeStamp.store(timeStamp, std::memory_order_relaxed);
+    m_clockMaxAdvance.store(maxAdvance, std::memory_order_relaxed);
+    m_clockRate.store(rate, std::memory_order_relaxed);
+    m_clockUpdateTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(),
+                            std::memory_order_relaxed);
+    m_clockSequence.fetch_add(1, std::memory_order_release);
 }
 
 
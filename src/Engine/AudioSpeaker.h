@@ -1,10 +1,14 @@
 #include "Interface/IAudioSpeaker.h"
+#include "Core/PCMRingBuffer.h"
+#include "Core/SPSCQueue.h"
+#include "Core/SyncNotifier.h"
 #include <QAudioDevice>
 #include <QAudioFormat>
 #include <QAudioSink>
 #include <QIODevice>
 #include <QMediaDevices>
-#include <mutex>
+#include <atomic>
+#include <thread>
 
 #include <stdint.h>
 #include <stdio.h>
@@ -17,23 +21,67 @@ public:
     AudioSpeaker(unsigned int channels, unsigned int sampleRate);
     ~AudioSpeaker() override;
 
-    // 播放音频，将音频加入到队列中
+    // 播放音频：交给写入线程后立即返回，不阻塞调用方（同步线程）
     void PlayAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) override;
     void Stop() override;
+    double GetPlaybackTimeStamp() override;
 
 private:
     // 继承 QIODevice 需重写方法
     qint64 readData(char *data, qint64 maxlen) override;
     qint64 writeData(const char *data, qint64 len) override { return 0; }
+
+    // 设备回调线程调用：根据已交给设备的样本数和设备缓冲中未播出的数据更新播放时钟
+    void UpdatePlaybackClock(size_t flushPosition, size_t samplesRead);
+    void PublishPlaybackClock(double timeStamp, double maxAdvance, double rate);
+
+    // 写入线程：把待播放的样本写入环形缓冲区，缓冲区满时等待设备回调唤醒
+    void WriterLoop();
+    void WriteAudioSamples(const std::shared_ptr<IAudioSamples>& audioSamples, uint64_t generation);
 private:
     // QAudioSink *m_audioSink{nullptr};
     QMediaDevices *m_outputDevices{nullptr};        // 管理输出设备
     QAudioDevice outputDevice;                      // 实际输出设备
     QAudioSink *m_audioSinkOutput{nullptr};         // 
 
-    IAudioSamples m_audioSamples;                   // 当前播放的音频样本
-    std::list<std::shared_ptr<IAudioSamples>> m_audioSampleList;        // 待播放音频样本队列
-    std::mutex m_audioSamplesListMutex;
+    // PlayAudioSamples -> readData，约 100ms 的 PCM，设备回调中不加锁、不分配内存
+    PCMRingBuffer m_pcmBuffer;
+    // Stop 时记录写入位置，readData 丢弃该位置之前的样本
+    std::atomic<size_t> m_flushPosition{0};
+    // 每次 Stop 递增，用于打断正在等待缓冲区空间的写入
+    std::atomic<uint64_t> m_stopGeneration{0};
+    std::atomic<bool> m_abort{false};
+
+    // PlayAudioSamples -> 写入线程。样本带着解码器的资源计数，队列中最多只有几段，Push 不会等待
+    struct PendingSamples {
+        std::shared_ptr<IAudioSamples> audioSamples;
+        uint64_t generation{0};     // 入队时的 Stop 次数，之后又 Stop 过的样本直接丢弃
+    };
+    static constexpr size_t kPendingSamplesCapacity = 32;
+    SPSCQueue<PendingSamples> m_pendingSamples{kPendingSamplesCapacity};
+    std::thread m_writerThread;
+    SyncNotifier m_writerNotifier;                  // 新样本、缓冲区腾出空间、Stop 时唤醒写入线程
+    std::atomic<bool> m_writerWaitingForSpace{false};
+
+    unsigned int m_channels{2};
+    unsigned int m_sampleRate{44100};
+
+    // 时间戳标记：环形缓冲区中写入位置 position 处样本的时间戳，PlayAudioSamples -> readData
+    // rate 为之后每个样本代表的媒体时长倍数（倍速播放时的变速音频）
+    struct TimeStampMark {
+        size_t position{0};
+        double timeStamp{-1.0};
+        double rate{1.0};
+    };
+    SPSCQueue<TimeStampMark> m_timeStampMarks{256};
+    TimeStampMark m_currentMark;                    // 设备回调线程使用，当前播出位置所在的标记
+
+    // 播放时钟，设备回调线程写、任意线程读，用序号（奇数表示写入中）保证读到一致的快照
+    std::atomic<uint32_t> m_clockSequence{0};
+    std::atomic<double> m_clockTimeStamp{-1.0};     // 上次回调时的播出时间戳
+    std::atomic<double> m_clockMaxAdvance{0.0};     // 上次回调后设备中尚可播出的媒体时长，外推不超过该值
+    std::atomic<double> m_clockRate{1.0};           // 播出中的音频的倍速，外推时媒体时间按该倍速推进
+    std::atomic<int64_t> m_clockUpdateTime{0};      // 上次回调的时刻（steady_clock 纳秒）
 };
 
 
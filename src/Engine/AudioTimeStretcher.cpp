@@ -0,0 +1,172 @@
+#include "AudioTimeStretcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AV_TIME_STRETCH_SSE2 1
+#endif
+
+namespace av {
+
+namespace {
+
+constexpr double kWindowSeconds = 0.04;     // 片段长度，兼顾语音清晰度与低音
+constexpr double kSearchSeconds = 0.012;    // 单侧搜索范围，覆盖常见基音周期
+constexpr double kPi = 3.14159265358979323846;
+
+// 相似度搜索的热点：同时计算点积与候选片段能量，SSE2 一次处理 4 个样本
+void DotAndEnergy(const float* templ, const float* candidate, size_t count, float& dot, float& energy) {
+    size_t i = 0;
+    dot = 0.0f;
+    energy = 0.0f;
+#ifdef AV_TIME_STRETCH_SSE2
+    __m128 dotSum = _mm_setzero_ps();
+    __m128 energySum = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 a = _mm_loadu_ps(templ + i);
+        __m128 b = _mm_loadu_ps(candidate + i);
+        dotSum = _mm_add_ps(dotSum, _mm_mul_ps(a, b));
+        energySum = _mm_add_ps(energySum, _mm_mul_ps(b, b));
+    }
+    alignas(16) float dots[4];
+    alignas(16) float energies[4];
+    _mm_store_ps(dots, dotSum);
+    _mm_store_ps(energies, energySum);
+    dot = dots[0] + dots[1] + dots[2] + dots[3];
+    energy = energies[0] + energies[1] + energies[2] + energies[3];
+#endif
+    for (; i < count; ++i) {
+        dot += templ[i] * candidate[i];
+        energy += candidate[i] * candidate[i];
+    }
+}
+
+}  // namespace
+
+AudioTimeStretcher::AudioTimeStretcher(unsigned int channels, unsigned int sampleRate)
+    : m_channels(std::max(channels, 1u)), m_sampleRate(std::max(sampleRate, 1u)) {
+    m_synthesisHop = std::max<size_t>(static_cast<size_t>(m_sampleRate * kWindowSeconds / 2), 1);
+    m_windowFrames = m_synthesisHop * 2;
+    m_searchFrames = static_cast<size_t>(m_sampleRate * kSearchSeconds);
+
+    // 周期 Hann 窗，步长为窗长一半时重叠部分之和恒为 1
+    m_window.resize(m_windowFrames);
+    for (size_t i = 0; i < m_windowFrames; ++i) {
+        m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / m_windowFrames));
+    }
+    Reset();
+}
+
+void AudioTimeStretcher::SetRate(double rate) { m_rate = rate; }
+
+void AudioTimeStretcher::Reset() {
+    m_input.clear();
+    m_mono.clear();
+    m_inputFrames = 0;
+    m_inputTimeStamp = 0.0;
+    m_overlap.assign(m_synthesisHop * m_channels, 0.0f);
+    m_analysisPosition = 0.0;
+    m_previousSegment = 0;
+    m_hasPreviousSegment = false;
+}
+
+double AudioTimeStretcher::GetExpectedTimeStamp() const {
+    return m_inputTimeStamp + static_cast<double>(m_inputFrames) / m_sampleRate;
+}
+
+bool AudioTimeStretcher::Process(const int16_t* samples, size_t frameCount, double timeStamp,
+                                 std::vector<int16_t>& output, double& outputTimeStamp) {
+    if (frameCount > 0) {
+        if (m_inputFrames == 0) m_inputTimeStamp = timeStamp;
+        m_input.reserve(m_input.size() + frameCount * m_channels);
+        m_mono.reserve(m_mono.size() + frameCount);
+        const float scale = 1.0f / 32768.0f;
+        for (size_t i = 0; i < frameCount; ++i) {
+            float mono = 0.0f;
+            for (unsigned int ch = 0; ch < m_channels; ++ch) {
+                float value = samples[i * m_channels + ch] * scale;
+                m_input.push_back(value);
+                mono += value;
+            }
+            m_mono.push_back(mono);
+        }
+        m_inputFrames += frameCount;
+    }
+
+    bool produced = false;
+    while (true) {
+        auto nominal = static_cast<size_t>(std::llround(m_analysisPosition));
+        // 搜索范围内的所有候选片段都必须已经到达
+        if (nominal + m_searchFrames + m_windowFrames > m_inputFrames) break;
+
+        size_t segment = m_hasPreviousSegment ? FindBestSegment(nominal, m_previousSegment + m_synthesisHop) : nominal;
+        if (!produced) {
+            outputTimeStamp = m_inputTimeStamp + static_cast<double>(nominal) / m_sampleRate;
+            produced = true;
+        }
+        OutputSegment(segment, output);
+        m_previousSegment = segment;
+        m_hasPreviousSegment = true;
+        m_analysisPosition += m_synthesisHop * m_rate;
+    }
+
+    // 保留下一次搜索需要的数据：上一片段的自然延续（模板）与下一片段的搜索范围
+    auto nextNominal = static_cast<size_t>(std::llround(m_analysisPosition));
+    size_t keepFrom = nextNominal > m_searchFrames ? nextNominal - m_searchFrames : 0;
+    if (m_hasPreviousSegment) keepFrom = std::min(keepFrom, m_previousSegment + m_synthesisHop);
+    TrimInput(std::min(keepFrom, m_inputFrames));
+    return produced;
+}
+
+size_t AudioTimeStretcher::FindBestSegment(size_t nominalPosition, size_t templatePosition) const {
+    const size_t overlapFrames = m_synthesisHop;
+    const float* templ = m_mono.data() + templatePosition;
+    size_t begin = nominalPosition > m_searchFrames ? nominalPosition - m_searchFrames : 0;
+    size_t end = nominalPosition + m_searchFrames;
+
+    // 归一化互相关：只按候选片段能量归一化，模板能量对所有候选相同
+    size_t best = nominalPosition;
+    float bestScore = -1e30f;
+    for (size_t candidate = begin; candidate <= end; ++candidate) {
+        float dot = 0.0f;
+        float energy = 0.0f;
+        DotAndEnergy(templ, m_mono.data() + candidate, overlapFrames, dot, energy);
+        float score = dot / std::sqrt(energy + 1e-9f);
+        if (score > bestScore) {
+            bestScore = score;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+void AudioTimeStretcher::OutputSegment(size_t position, std::vector<int16_t>& output) {
+    const size_t hop = m_synthesisHop;
+    const float* segment = m_input.data() + position * m_channels;
+    size_t outputStart = output.size();
+    output.resize(outputStart + hop * m_channels);
+
+    // 前半段与上一片段的后半段相加后输出，后半段留给下一片段
+    for (size_t i = 0; i < hop; ++i) {
+        for (unsigned int ch = 0; ch < m_channels; ++ch) {
+            size_t index = i * m_channels + ch;
+            float value = m_overlap[index] + segment[index] * m_window[i];
+            output[outputStart + index] = static_cast<int16_t>(std::clamp(value * 32768.0f, -32768.0f, 32767.0f));
+            m_overlap[index] = segment[hop * m_channels + index] * m_window[hop + i];
+        }
+    }
+}
+
+void AudioTimeStretcher::TrimInput(size_t keepFrom) {
+    if (keepFrom == 0) return;
+    m_input.erase(m_input.begin(), m_input.begin() + keepFrom * m_channels);
+    m_mono.erase(m_mono.begin(), m_mono.begin() + keepFrom);
+    m_inputFrames -= keepFrom;
+    m_inputTimeStamp += static_cast<double>(keepFrom) / m_sampleRate;
+    m_analysisPosition -= static_cast<double>(keepFrom);
+    m_previousSegment = m_previousSegment > keepFrom ? m_previousSegment - keepFrom : 0;
+}
+
+}  // namespace av
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace av {
+
+// WSOLA（波形相似重叠相加）变速不变调
+// 以固定的合成步长输出加窗片段，分析步长 = 合成步长 * 倍速；每个片段在名义位置附近搜索
+// 与上一片段自然延续最相似的位置，避免相位不连续。只在一个线程中使用
+class AudioTimeStretcher {
+public:
+    AudioTimeStretcher(unsigned int channels, unsigned int sampleRate);
+
+    // 倍速，下一个片段开始生效
+    void SetRate(double rate);
+    double GetRate() const { return m_rate; }
+
+    // 送入交错排列的 int16 PCM，timeStamp 为首帧的媒体时间（秒）；
+    // 追加本次可以输出的 PCM 到 output，返回 false 表示数据不足、暂无输出。
+    // outputTimeStamp 为输出首帧对应的媒体时间
+    bool Process(const int16_t* samples, size_t frameCount, double timeStamp, std::vector<int16_t>& output,
+                 double& outputTimeStamp);
+
+    // 丢弃所有缓存数据，跳转等不连续的输入之前调用
+    void Reset();
+    bool IsEmpty() const { return m_inputFrames == 0; }
+    // 下一次送入的数据应有的媒体时间，用于检测输入是否连续
+    double GetExpectedTimeStamp() const;
+
+private:
+    // 在名义位置附近搜索与模板最相似的片段起点
+    size_t FindBestSegment(size_t nominalPosition, size_t templatePosition) const;
+    void OutputSegment(size_t position, std::vector<int16_t>& output);
+    void TrimInput(size_t keepFrom);
+
+private:
+    unsigned int m_channels{2};
+    unsigned int m_sampleRate{44100};
+    double m_rate{1.0};
+
+    size_t m_windowFrames{0};           // 片段长度
+    size_t m_synthesisHop{0};           // 合成步长，窗长的一半，相邻 Hann 窗之和恒为 1
+    size_t m_searchFrames{0};           // 单侧搜索范围
+    std::vector<float> m_window;
+
+    std::vector<float> m_input;         // 交错排列的输入
+    std::vector<float> m_mono;          // 输入的单声道混音，只用于相似度计算
+    size_t m_inputFrames{0};
+    double m_inputTimeStamp{0.0};       // m_input 首帧的媒体时间
+
+    std::vector<float> m_overlap;       // 上一片段后半段（已加窗），与下一片段前半段相加后输出
+    double m_analysisPosition{0.0};     // 下一片段在输入中的名义位置（帧）
+    size_t m_previousSegment{0};        // 上一片段的实际起点（帧）
+    bool m_hasPreviousSegment{false};
+};
+
+}  // namespace av
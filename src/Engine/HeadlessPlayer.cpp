@@ -0,0 +1,284 @@
+#include "HeadlessPlayer.h"
+
+#include <algorithm>
+
+namespace av {
+
+namespace {
+
+constexpr float kMinPlaybackRate = 0.25f;
+constexpr float kMaxPlaybackRate = 4.0f;
+// 达到该倍速时解码器跳过非参考帧
+constexpr float kSkipNonReferencePlaybackRate = 2.0f;
+
+}  // namespace
+
+IHeadlessPlayer* IHeadlessPlayer::Create() { return new HeadlessPlayer(); }
+
+HeadlessPlayer::HeadlessPlayer() {
+    m_taskPool = std::make_shared<TaskPool>(1);
+
+    // 文件读取器，YUV 帧只在需要滤镜时才转换为 RGBA
+    m_fileReader = std::shared_ptr<IFileReader>(IFileReader::Create());
+    m_fileReader->SetVideoYUVOutputEnabled(true);
+
+    // 音视频同步器
+    m_avSynchronizer = std::make_shared<AVSynchronizer>();
+
+    // 音频处理管线及输出
+    m_audioPipeline = std::shared_ptr<IAudioPipeline>(IAudioPipeline::Create(2, 44100));
+    m_audioSpeaker = std::make_shared<NullAudioSpeaker>(2, 44100);
+    ApplySyncClockType();
+
+    m_videoFilterChain = std::make_shared<CPUVideoFilterChain>();
+
+    // 串联各个模块
+    m_fileReader->SetListener(this);
+    m_avSynchronizer->SetListener(this);
+    m_audioPipeline->SetListener(this);
+}
+
+HeadlessPlayer::~HeadlessPlayer() {
+    m_fileReader->Stop();
+    m_avSynchronizer->Stop();
+    m_audioSpeaker->Stop();
+    // 等待已提交的视频处理任务执行完毕
+    m_taskPool = nullptr;
+
+    m_fileReader = nullptr;
+    m_avSynchronizer = nullptr;
+    m_audioPipeline = nullptr;
+    m_audioSpeaker = nullptr;
+    m_fileWriter = nullptr;
+}
+
+void HeadlessPlayer::SetListener(IHeadlessPlayer::Listener* listener) {
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    m_listener = listener;
+}
+
+void HeadlessPlayer::SetPlaybackListener(std::shared_ptr<IPlaybackListener> listener) {
+    std::lock_guard<std::recursive_mutex> lock(m_playbackListenerMutex);
+    m_playbackListener = listener;
+}
+
+bool HeadlessPlayer::Open(const std::string& filePath) {
+    if (!m_fileReader) return false;
+    if (!m_fileReader->Open(filePath)) return false;
+    ApplySyncClockType();
+    return true;
+}
+
+void HeadlessPlayer::Play() {
+    if (m_fileReader) m_fileReader->Start();
+    m_isPlaying = true;
+
+    std::lock_guard<std::recursive_mutex> lock(m_playbackListenerMutex);
+    if (m_playbackListener) m_playbackListener->NotifyPlaybackStarted();
+}
+
+void HeadlessPlayer::Pause() {
+    if (!m_fileReader) return;
+    m_fileReader->Pause();
+    m_isPlaying = false;
+
+    std::lock_guard<std::recursive_mutex> lock(m_playbackListenerMutex);
+    if (m_playbackListener) m_playbackListener->NotifyPlaybackPaused();
+}
+
+void HeadlessPlayer::SeekTo(float progress, SeekMode mode) {
+    if (IsPlaying()) Pause();
+    if (!m_fileReader) return;
+    m_fileReader->SeekTo(progress, mode);
+    m_avSynchronizer->Reset();
+    if (m_audioSpeaker) m_audioSpeaker->Stop();
+}
+
+bool HeadlessPlayer::IsPlaying() { return m_isPlaying; }
+
+void HeadlessPlayer::SetSyncClockType(SyncClockType type) {
+    m_syncClockType = type;
+    ApplySyncClockType();
+}
+
+void HeadlessPlayer::SetPlaybackRate(float rate) {
+    rate = std::clamp(rate, kMinPlaybackRate, kMaxPlaybackRate);
+    m_playbackRate = rate;
+    m_avSynchronizer->SetPlaybackRate(rate);
+    m_audioPipeline->SetPlaybackRate(rate);
+    UpdateVideoSkipNonReferenceFrames();
+}
+
+float HeadlessPlayer::GetPlaybackRate() { return m_playbackRate; }
+
+VideoPresentationStats HeadlessPlayer::GetVideoPresentationStats() {
+    auto stats = m_avSynchronizer->GetPresentationStats();
+    stats.skippedFrames = m_fileReader->GetVideoSkippedFrameCount();
+    return stats;
+}
+
+void HeadlessPlayer::UpdateVideoSkipNonReferenceFrames() {
+    // 高倍速时大部分帧会被抽掉，跳过非参考帧让解码跟上倍速
+    bool skip = m_videoLagging || m_playbackRate >= kSkipNonReferencePlaybackRate;
+    if (m_fileReader) m_fileReader->SetVideoSkipNonReferenceFrames(skip);
+}
+
+void HeadlessPlayer::ApplySyncClockType() {
+    SyncClockType type = m_syncClockType;
+    if (type == SyncClockType::kAuto) {
+        // 没有音频流（或尚未打开文件）时无法以音频为准
+        type = m_fileReader && m_fileReader->GetAudioStream() ? SyncClockType::kAudio : SyncClockType::kExternal;
+    }
+    // 不限速时扬声器也立即消费音频，否则解码器仍会被音频按真实速度限速
+    m_audioSpeaker->SetPaced(type != SyncClockType::kUnpaced);
+    // 音频主时钟以设备实际播出的位置为准
+    m_avSynchronizer->SetMasterClock(
+        IMasterClock::Create(type, [speaker = std::weak_ptr<IAudioSpeaker>(m_audioSpeaker)]() {
+            auto audioSpeaker = speaker.lock();
+            return audioSpeaker ? audioSpeaker->GetPlaybackTimeStamp() : -1.0;
+        }));
+}
+
+std::shared_ptr<IVideoFilter> HeadlessPlayer::AddVideoFilter(VideoFilterType type) {
+    return m_videoFilterChain->AddVideoFilter(type);
+}
+
+void HeadlessPlayer::RemoveVideoFilter(VideoFilterType type) { m_videoFilterChain->RemoveVideoFilter(type); }
+
+bool HeadlessPlayer::StartRecording(const std::string& outputFilePath, int flags) {
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->StopWriter();
+
+    // 没有滤镜时直接复制数据包，失败时回退到重新编码
+    if (m_videoFilterChain->Empty()) {
+        m_fileWriter = std::shared_ptr<IFileWriter>(IFileWriter::CreateSoftware());
+        if (m_fileWriter->StartRemux(outputFilePath, m_fileReader->GetAudioStream(),
+                                     m_fileReader->GetVideoStream())) {
+            m_fileReader->SetPacketOutputEnabled(true);
+            m_isRecording = true;
+            return true;
+        }
+    }
+
+    m_fileWriter = std::shared_ptr<IFileWriter>(IFileWriter::CreateSoftware());
+
+    FileWriterParameters parameters;
+    parameters.width = m_fileReader->GetVideoWidth();
+    parameters.height = m_fileReader->GetVideoHeight();
+    m_isRecording = m_fileWriter->StartWriter(outputFilePath, parameters, flags);
+    return m_isRecording;
+}
+
+void HeadlessPlayer::StopRecording() {
+    m_fileReader->SetPacketOutputEnabled(false);
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) {
+        m_fileWriter->StopWriter();
+        m_fileWriter = nullptr;
+    }
+    m_isRecording = false;
+}
+
+bool HeadlessPlayer::IsRecording() { return m_isRecording; }
+
+void HeadlessPlayer::ProcessVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    m_videoFilterChain->Process(videoFrame);
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+        if (m_listener) m_listener->OnHeadlessPlayerNotifyVideoFrame(videoFrame);
+    }
+
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyVideoFrame(videoFrame);
+}
+
+// 继承自IFileReader::Listener
+void HeadlessPlayer::OnFileReaderNotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
+    if (m_avSynchronizer) m_avSynchronizer->NotifyAudioSamples(audioSamples);
+}
+
+void HeadlessPlayer::OnFileReaderNotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    if (m_avSynchronizer) m_avSynchronizer->NotifyVideoFrame(videoFrame);
+}
+
+void HeadlessPlayer::OnFileReaderNotifyAudioFinished() {
+    if (m_avSynchronizer) m_avSynchronizer->NotifyAudioFinished();
+}
+
+void HeadlessPlayer::OnFileReaderNotifyVideoFinished() {
+    if (m_avSynchronizer) m_avSynchronizer->NotifyVideoFinished();
+}
+
+void HeadlessPlayer::OnFileReaderNotifyAudioPacket(std::shared_ptr<IAVPacket> packet) {
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyAudioPacket(packet);
+}
+
+void HeadlessPlayer::OnFileReaderNotifyVideoPacket(std::shared_ptr<IAVPacket> packet) {
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyVideoPacket(packet);
+}
+
+// 继承自AVSynchronizer::Listener
+void HeadlessPlayer::OnAVSynchronizerNotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
+    if (m_audioPipeline) m_audioPipeline->NotifyAudioSamples(audioSamples);
+}
+
+void HeadlessPlayer::OnAVSynchronizerNotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    // 滤镜处理放到独立线程，避免阻塞同步线程分发音频
+    m_taskPool->SubmitTask([this, videoFrame]() { ProcessVideoFrame(videoFrame); }, TaskPriority::kNormal,
+                           kVideoWorker);
+}
+
+void HeadlessPlayer::OnAVSynchronizerNotifyAudioFinished() {
+    if (m_audioPipeline) m_audioPipeline->NotifyAudioFinished();
+}
+
+void HeadlessPlayer::OnAVSynchronizerNotifyVideoFinished() {
+    // 与视频帧走同一线程，保证结束标记在最后一帧之后
+    m_taskPool->SubmitTask(
+        [this]() {
+            std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+            if (m_fileWriter) m_fileWriter->NotifyVideoFinished();
+        },
+        TaskPriority::kNormal, kVideoWorker);
+}
+
+void HeadlessPlayer::OnAVSynchronizerNotifyVideoLagging(bool lagging) {
+    // 持续落后时解码器跳过非参考帧，从源头减少需要处理的帧
+    m_videoLagging = lagging;
+    UpdateVideoSkipNonReferenceFrames();
+}
+
+// 继承自IAudioPipeline::Listener
+void HeadlessPlayer::OnAudioPipelineNotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
+    if (m_audioSpeaker) m_audioSpeaker->PlayAudioSamples(audioSamples);
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+        if (m_listener) m_listener->OnHeadlessPlayerNotifyAudioSamples(audioSamples);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+        if (m_fileWriter) m_fileWriter->NotifyAudioSamples(audioSamples);
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_playbackListenerMutex);
+    if (m_playbackListener) {
+        m_playbackListener->NotifyPlaybackTimeChanged(audioSamples->GetTimeStamp(), m_fileReader->GetDuration());
+    }
+}
+
+void HeadlessPlayer::OnAudioPipelineNotifyFinished() {
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_playbackListenerMutex);
+        if (m_playbackListener) m_playbackListener->NotifyPlaybackEOF();
+    }
+
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyAudioFinished();
+}
+
+}  // namespace av
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AVSynchronizer.h"
+#include "Core/TaskPool.h"
+#include "IHeadlessPlayer.h"
+#include "Interface/IAudioPipeline.h"
+#include "NullAudioSpeaker.h"
+#include "Interface/IFileReader.h"
+#include "Interface/IFileWriter.h"
+#include "VideoFilter/CPUVideoFilter.h"
+
+namespace av {
+
+class HeadlessPlayer : public IHeadlessPlayer,
+                       public IFileReader::Listener,
+                       public AVSynchronizer::Listener,
+                       public IAudioPipeline::Listener {
+public:
+    HeadlessPlayer();
+    ~HeadlessPlayer() override;
+
+    void SetListener(IHeadlessPlayer::Listener* listener) override;
+    void SetPlaybackListener(std::shared_ptr<IPlaybackListener> listener) override;
+
+    bool Open(const std::string& filePath) override;
+    void Play() override;
+    void Pause() override;
+    void SeekTo(float progress, SeekMode mode) override;
+    bool IsPlaying() override;
+    void SetSyncClockType(SyncClockType type) override;
+    void SetPlaybackRate(float rate) override;
+    float GetPlaybackRate() override;
+    VideoPresentationStats GetVideoPresentationStats() override;
+
+    std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) override;
+    void RemoveVideoFilter(VideoFilterType type) override;
+
+    bool StartRecording(const std::string& outputFilePath, int flags) override;
+    void StopRecording() override;
+    bool IsRecording() override;
+
+private:
+    // 按当前设置与打开的文件创建主时钟
+    void ApplySyncClockType();
+    // 视频持续落后或高倍速播放时，解码器跳过非参考帧
+    void UpdateVideoSkipNonReferenceFrames();
+    // 在视频处理线程上执行滤镜并分发
+    void ProcessVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
+
+    // 继承自IFileReader::Listener
+    void OnFileReaderNotifyAudioSamples(std::shared_ptr<IAudioSamples>) override;
+    void OnFileReaderNotifyVideoFrame(std::shared_ptr<IVideoFrame>) override;
+    void OnFileReaderNotifyAudioFinished() override;
+    void OnFileReaderNotifyVideoFinished() override;
+    void OnFileReaderNotifyAudioPacket(std::shared_ptr<IAVPacket>) override;
+    void OnFileReaderNotifyVideoPacket(std::shared_ptr<IAVPacket>) override;
+
+    // 继承自AVSynchronizer::Listener
+    void OnAVSynchronizerNotifyAudioSamples(std::shared_ptr<IAudioSamples>) override;
+    void OnAVSynchronizerNotifyVideoFrame(std::shared_ptr<IVideoFrame>) override;
+    void OnAVSynchronizerNotifyAudioFinished() override;
+    void OnAVSynchronizerNotifyVideoFinished() override;
+    void OnAVSynchronizerNotifyVideoLagging(bool lagging) override;
+
+    // 继承自IAudioPipeline::Listener
+    void OnAudioPipelineNotifyAudioSamples(std::shared_ptr<IAudioSamples>) override;
+    void OnAudioPipelineNotifyFinished() override;
+
+private:
+    IHeadlessPlayer::Listener* m_listener{nullptr};
+    std::recursive_mutex m_listenerMutex;
+
+    std::shared_ptr<IPlaybackListener> m_playbackListener;
+    std::recursive_mutex m_playbackListenerMutex;
+
+    // 文件读取器
+    std::shared_ptr<IFileReader> m_fileReader;
+
+    // 音画同步
+    std::shared_ptr<AVSynchronizer> m_avSynchronizer;
+
+    // 音频处理管线与不发声的扬声器，扬声器负责按真实速度消费音频（不限速时立即消费）
+    std::shared_ptr<IAudioPipeline> m_audioPipeline;
+    std::shared_ptr<NullAudioSpeaker> m_audioSpeaker;
+
+    // CPU 滤镜链，只在视频处理线程上调用 Process
+    std::shared_ptr<CPUVideoFilterChain> m_videoFilterChain;
+
+    // 视频录制
+    std::shared_ptr<IFileWriter> m_fileWriter;
+    std::mutex m_fileWriterMutex;
+
+    // 单线程执行视频处理，任务固定在同一线程上按提交顺序执行
+    std::shared_ptr<TaskPool> m_taskPool;
+    static constexpr int kVideoWorker = 0;
+
+    std::atomic<bool> m_isPlaying{false};
+    std::atomic<SyncClockType> m_syncClockType{SyncClockType::kAuto};
+    std::atomic<float> m_playbackRate{1.0f};
+    std::atomic<bool> m_videoLagging{false};
+    std::atomic<bool> m_isRecording{false};
+};
+
+}  // namespace av
@@ -0,0 +1,138 @@
+#include "MasterClock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace av {
+
+std::shared_ptr<IMasterClock> IMasterClock::Create(SyncClockType type, std::function<double()> audioDeviceClock) {
+    switch (type) {
+        case SyncClockType::kAudio:
+            return std::make_shared<AudioMasterClock>(std::move(audioDeviceClock));
+        case SyncClockType::kVideo:
+            return std::make_shared<VideoMasterClock>();
+        case SyncClockType::kUnpaced:
+            return std::make_shared<UnpacedClock>();
+        case SyncClockType::kExternal:
+        default:
+            return std::make_shared<SystemClock>();
+    }
+}
+
+double SystemClock::GetTime() { return m_anchored ? GetSystemTime() : -1.0; }
+
+void SystemClock::OnAudioDispatched(double timeStamp) {
+    if (!m_anchored || std::abs(timeStamp - GetSystemTime()) > kResyncThreshold) Anchor(timeStamp);
+}
+
+void SystemClock::OnVideoDispatched(double timeStamp) {
+    if (!m_anchored || std::abs(timeStamp - GetSystemTime()) > kResyncThreshold) Anchor(timeStamp);
+}
+
+void SystemClock::Reset() {
+    m_anchored = false;
+    // 漂移是时钟源的固有属性，跳转后保留估计值，只丢弃采样起点
+    m_hasDriftSample = false;
+}
+
+void SystemClock::SetRate(double rate) {
+    // 在当前时间处重新锚定，之前流逝的时间仍按原倍速计算
+    if (m_anchored) {
+        auto now = Clock::now();
+        Anchor(GetSystemTime(now), now);
+    }
+    m_rate = rate;
+    m_hasDriftSample = false;
+}
+
+void SystemClock::Anchor(double timeStamp, Clock::time_point now) {
+    m_anchored = true;
+    m_anchorTimeStamp = timeStamp;
+    m_anchorTime = now;
+}
+
+double SystemClock::GetSystemTime(Clock::time_point now) const {
+    double elapsed = std::chrono::duration<double>(now - m_anchorTime).count();
+    return m_anchorTimeStamp + elapsed * m_rate * (1.0 + m_drift);
+}
+
+void SystemClock::UpdateDrift(double sourceTime, Clock::time_point now) {
+    // 采样间隔太短时读数抖动占主导，至少间隔 1 秒再计算
+    constexpr double kMinInterval = 1.0;
+    // 速率偏差超过该值说明时钟源发生了跳变（暂停、跳转），重新采样
+    constexpr double kMaxRateError = 0.05;
+    constexpr double kSmoothing = 0.1;
+
+    if (!m_hasDriftSample) {
+        m_hasDriftSample = true;
+        m_driftSourceTime = sourceTime;
+        m_driftSystemTime = now;
+        return;
+    }
+    double systemElapsed = std::chrono::duration<double>(now - m_driftSystemTime).count();
+    if (systemElapsed < kMinInterval) return;
+
+    // 时钟源按倍速推进，先换算回原速再与系统时钟比较
+    double rateError = (sourceTime - m_driftSourceTime) / (systemElapsed * m_rate) - 1.0;
+    if (std::abs(rateError) <= kMaxRateError) {
+        m_drift += (rateError - m_drift) * kSmoothing;
+    }
+    m_driftSourceTime = sourceTime;
+    m_driftSystemTime = now;
+}
+
+AudioMasterClock::AudioMasterClock(std::function<double()> deviceClock) : m_deviceClock(std::move(deviceClock)) {}
+
+double AudioMasterClock::GetTime() {
+    auto now = Clock::now();
+    double deviceTime = m_deviceClock ? m_deviceClock() : -1.0;
+
+    // 音频结束后设备时钟停在最后一个样本，之后由系统时钟接着推进
+    if (m_audioFinished && IsAnchored()) return std::max(deviceTime, GetSystemTime(now));
+
+    if (deviceTime >= 0) {
+        UpdateDrift(deviceTime, now);
+        Anchor(deviceTime, now);
+        return deviceTime;
+    }
+    // 设备时钟不可用（刚开始播放或刚刚跳转），退回到最近送出的音频时间戳
+    return m_lastAudioTimeStamp;
+}
+
+void AudioMasterClock::OnAudioDispatched(double timeStamp) { m_lastAudioTimeStamp = timeStamp; }
+
+void AudioMasterClock::OnVideoDispatched(double timeStamp) {
+    // 没有任何音频播出时由视频开始计时
+    if (m_audioFinished && !IsAnchored()) Anchor(timeStamp);
+}
+
+void AudioMasterClock::OnAudioFinished() {
+    m_audioFinished = true;
+    if (!IsAnchored() && m_lastAudioTimeStamp >= 0) Anchor(m_lastAudioTimeStamp);
+}
+
+void AudioMasterClock::Reset() {
+    SystemClock::Reset();
+    m_lastAudioTimeStamp = -1.0;
+    m_audioFinished = false;
+}
+
+void VideoMasterClock::OnAudioDispatched(double timeStamp) {
+    // 视频到达之前（或没有视频流时）先由音频开始计时
+    if (!m_hasVideo && !IsAnchored()) Anchor(timeStamp);
+}
+
+void VideoMasterClock::OnVideoDispatched(double timeStamp) {
+    m_hasVideo = true;
+    if (!IsAnchored() || std::abs(timeStamp - GetSystemTime()) > kVideoResyncThreshold) Anchor(timeStamp);
+}
+
+void VideoMasterClock::Reset() {
+    SystemClock::Reset();
+    m_hasVideo = false;
+}
+
+double UnpacedClock::GetTime() { return std::numeric_limits<double>::infinity(); }
+
+}  // namespace av
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Define/SyncClockType.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace av {
+
+// 音画同步的主时钟，只在同步线程调用
+class IMasterClock {
+public:
+    virtual ~IMasterClock() = default;
+
+    // 当前时钟时间（秒），尚未开始计时返回负数
+    virtual double GetTime() = 0;
+
+    // 同步线程送出音频/视频数据时调用，用于锚定与校准时钟
+    virtual void OnAudioDispatched(double timeStamp) {}
+    virtual void OnVideoDispatched(double timeStamp) {}
+    virtual void OnAudioFinished() {}
+
+    // 跳转或刷新后重新计时
+    virtual void Reset() = 0;
+
+    // 尚未开始计时时，视频能否直接送出并由它开始计时；音频主时钟需要等待音频
+    virtual bool CanStartWithVideo() const { return true; }
+    // 音频是否需要按时钟节奏送出；音频主时钟由设备消费速度自然限速
+    virtual bool PacesAudio() const { return true; }
+    // 是否按时间节奏推进，返回 false 时所有数据到达即送出
+    virtual bool IsPaced() const { return true; }
+
+    // 播放倍速，时钟按该倍速推进；音频主时钟的设备时间戳本身已含倍速
+    virtual void SetRate(double rate) {}
+    virtual double GetRate() const { return 1.0; }
+
+    // 时钟源相对系统时钟的漂移估计（秒/秒）
+    virtual double GetDrift() const { return 0.0; }
+    virtual SyncClockType GetType() const = 0;
+
+    // audioDeviceClock 为音频设备的播出时间戳，仅音频主时钟使用；kAuto 由调用方先行解析
+    static std::shared_ptr<IMasterClock> Create(SyncClockType type, std::function<double()> audioDeviceClock = nullptr);
+};
+
+// 以系统时钟推进的时钟：在某个时间戳处锚定，之后按流逝时间（含漂移修正）前进
+class SystemClock : public IMasterClock {
+public:
+    double GetTime() override;
+    void OnAudioDispatched(double timeStamp) override;
+    void OnVideoDispatched(double timeStamp) override;
+    void Reset() override;
+    void SetRate(double rate) override;
+    double GetRate() const override { return m_rate; }
+    double GetDrift() const override { return m_drift; }
+    SyncClockType GetType() const override { return SyncClockType::kExternal; }
+
+protected:
+    using Clock = std::chrono::steady_clock;
+
+    void Anchor(double timeStamp, Clock::time_point now = Clock::now());
+    bool IsAnchored() const { return m_anchored; }
+    double GetSystemTime(Clock::time_point now = Clock::now()) const;
+    // 用时钟源的一次读数更新漂移估计，读数间隔足够长时才计算，结果做指数平滑
+    void UpdateDrift(double sourceTime, Clock::time_point now = Clock::now());
+
+    // 数据时间戳与时钟相差超过该值视为断流（暂停、跳转），重新锚定
+    static constexpr double kResyncThreshold = 1.0;
+
+private:
+    bool m_anchored{false};
+    double m_anchorTimeStamp{0.0};
+    Clock::time_point m_anchorTime;
+    double m_rate{1.0};
+
+    double m_drift{0.0};
+    bool m_hasDriftSample{false};
+    double m_driftSourceTime{0.0};
+    Clock::time_point m_driftSystemTime;
+};
+
+// 音频主时钟：使用设备实际播出的位置；设备时钟不可用时退回到最近送出的音频时间戳，
+// 音频结束后按系统时钟继续推进，保证剩余视频正常播放
+class AudioMasterClock : public SystemClock {
+public:
+    explicit AudioMasterClock(std::function<double()> deviceClock);
+
+    double GetTime() override;
+    void OnAudioDispatched(double timeStamp) override;
+    void OnVideoDispatched(double timeStamp) override;
+    void OnAudioFinished() override;
+    void Reset() override;
+    bool CanStartWithVideo() const override { return m_audioFinished; }
+    bool PacesAudio() const override { return false; }
+    SyncClockType GetType() const override { return SyncClockType::kAudio; }
+
+private:
+    std::function<double()> m_deviceClock;
+    double m_lastAudioTimeStamp{-1.0};
+    bool m_audioFinished{false};
+};
+
+// 视频主时钟：由送出的视频时间戳驱动，偏离超过阈值即按视频重新锚定
+class VideoMasterClock : public SystemClock {
+public:
+    void OnAudioDispatched(double timeStamp) override;
+    void OnVideoDispatched(double timeStamp) override;
+    void Reset() override;
+    SyncClockType GetType() const override { return SyncClockType::kVideo; }
+
+private:
+    static constexpr double kVideoResyncThreshold = 0.1;
+    bool m_hasVideo{false};
+};
+
+// 不限速：时钟始终在所有数据之后，数据到达即送出
+class UnpacedClock : public IMasterClock {
+public:
+    double GetTime() override;
+    void Reset() override {}
+    bool PacesAudio() const override { return false; }
+    bool IsPaced() const override { return false; }
+    SyncClockType GetType() const override { return SyncClockType::kUnpaced; }
+    void SetRate(double rate) override { m_rate = rate; }
+    double GetRate() const override { return m_rate; }
+
+private:
+    double m_rate{1.0};
+};
+
+}  // namespace av
@@ -0,0 +1,96 @@
+#include "NullAudioSpeaker.h"
+
+#include <algorithm>
+
+namespace av {
+
+NullAudioSpeaker::NullAudioSpeaker(unsigned int channels, unsigned int sampleRate)
+    : m_channels(channels), m_sampleRate(sampleRate) {
+    m_thread = std::thread(&NullAudioSpeaker::ThreadLoop, this);
+}
+
+NullAudioSpeaker::~NullAudioSpeaker() {
+    m_abort = true;
+    m_notifier.Notify();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void NullAudioSpeaker::PlayAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
+    if (!audioSamples) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
+        m_audioSampleList.push_back(audioSamples);
+    }
+    m_notifier.Notify();
+}
+
+void NullAudioSpeaker::Stop() {
+    std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
+    m_audioSampleList.clear();
+    m_playingTimeStamp = -1.0;
+}
+
+void NullAudioSpeaker::SetPaced(bool paced) {
+    m_paced = paced;
+    m_notifier.Notify();
+}
+
+double NullAudioSpeaker::GetPlaybackTimeStamp() {
+    std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
+    if (m_playingTimeStamp < 0) return -1.0;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_playingStartTime).count();
+    return m_playingTimeStamp + std::clamp(elapsed, 0.0, m_playingDuration) * m_playingRate;
+}
+
+void NullAudioSpeaker::ThreadLoop() {
+    using Clock = std::chrono::steady_clock;
+    // 按累计播放时长计算截止时间，避免逐段休眠累积误差
+    auto deadline = Clock::now();
+
+    while (!m_abort) {
+        std::shared_ptr<IAudioSamples> audioSamples;
+        {
+            std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
+            if (!m_audioSampleList.empty()) {
+                audioSamples = m_audioSampleList.front();
+                m_audioSampleList.pop_front();
+            }
+        }
+        if (!audioSamples) {
+            m_notifier.Wait();
+            // 队列断流后重新计时，不补偿暂停期间的时间
+            deadline = Clock::now();
+            continue;
+        }
+
+        unsigned int channels = audioSamples->channels ? audioSamples->channels : m_channels;
+        unsigned int sampleRate = audioSamples->sampleRate ? audioSamples->sampleRate : m_sampleRate;
+        auto frameCount = audioSamples->pcmData.size() / channels;
+        auto duration = std::chrono::microseconds(frameCount * 1000000 / sampleRate);
+        {
+            std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
+            m_playingTimeStamp = audioSamples->GetTimeStamp();
+            m_playingDuration = std::chrono::duration<double>(duration).count();
+            m_playingRate = audioSamples->playbackRate;
+            m_playingStartTime = deadline;
+        }
+        deadline += duration;
+        if (!m_paced) {
+            deadline = Clock::now();
+            continue;
+        }
+
+        // 样本在“播放”结束后才释放；新样本到达也会唤醒等待，需要等到截止时间
+        for (auto now = Clock::now(); !m_abort && now < deadline; now = Clock::now()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+            m_notifier.Wait(static_cast<int>(remaining) + 1);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_audioSamplesListMutex);
+    m_audioSampleList.clear();
+}
+
+}  // namespace av
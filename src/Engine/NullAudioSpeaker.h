@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#include "Core/SyncNotifier.h"
+#include "Interface/IAudioSpeaker.h"
+
+namespace av {
+
+// 不输出声音的扬声器，按采样率实时消费音频样本
+// 样本释放后解码器才会继续解码，因此无界面播放仍以真实速度推进
+class NullAudioSpeaker : public IAudioSpeaker {
+public:
+    NullAudioSpeaker(unsigned int channels, unsigned int sampleRate);
+    ~NullAudioSpeaker() override;
+
+    void PlayAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) override;
+    void Stop() override;
+    double GetPlaybackTimeStamp() override;
+
+    // 关闭后样本到达即被消费，用于不限速的批处理
+    void SetPaced(bool paced);
+
+private:
+    void ThreadLoop();
+
+private:
+    unsigned int m_channels{2};
+    unsigned int m_sampleRate{44100};
+
+    std::list<std::shared_ptr<IAudioSamples>> m_audioSampleList;  // 待播放音频样本队列
+    std::mutex m_audioSamplesListMutex;
+
+    // 正在“播放”的样本，受 m_audioSamplesListMutex 保护
+    double m_playingTimeStamp{-1.0};
+    double m_playingDuration{0.0};
+    double m_playingRate{1.0};          // 变速样本的倍速，播放时长换算为媒体时长
+    std::chrono::steady_clock::time_point m_playingStartTime;
+
+    std::atomic<bool> m_paced{true};
+    std::atomic<bool> m_abort{false};
+    SyncNotifier m_notifier;
+    std::thread m_thread;
+};
+
+}  // namespace av
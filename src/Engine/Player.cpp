@@ -1,22 +1,33 @@
 #include "Player.h"
 
+#include <algorithm>
 #include <iostream>
 
-#include "Core/SyncNotifier.h"
-
 namespace av {
 
+namespace {
+
+constexpr float kMinPlaybackRate = 0.25f;
+constexpr float kMaxPlaybackRate = 4.0f;
+// 达到该倍速时解码器跳过非参考帧
+constexpr float kSkipNonReferencePlaybackRate = 2.0f;
+
+}  // namespace
+
 IPlayer* IPlayer::Create(GLContext glContext) { return new Player(glContext); }
 
 Player::Player(GLContext& glContext) : m_glContext(glContext), m_taskPoolGLContext(glContext) {
-    m_taskPool = std::make_shared<TaskPool>();
+    // 提交的任务都固定在持有共享上下文的 GL 工作线程上执行，一个工作线程即可
+    m_taskPool = std::make_shared<TaskPool>(1);
     InitTaskPoolGLContext();
 
     // 文件读取器
     m_fileReader = std::shared_ptr<IFileReader>(IFileReader::Create());
+    // 颜色转换交给 VideoPipeline 的着色器完成
+    m_fileReader->SetVideoYUVOutputEnabled(true);
 
     // 音视频同步器
-    m_avSynchronizer = std::make_shared<AVSynchronizer>(m_glContext);
+    m_avSynchronizer = std::make_shared<AVSynchronizer>();
 
     // 音视频处理管线
     m_audioPipeline = std::shared_ptr<IAudioPipeline>(IAudioPipeline::Create(2, 44100));
@@ -24,6 +35,7 @@ Player::Player(GLContext& glContext) : m_glContext(glContext), m_taskPoolGLConte
 
     // 音频输出设备
     m_audioSpeaker = std::shared_ptr<IAudioSpeaker>(IAudioSpeaker::Create(2, 44100));
+    ApplySyncClockType();
 
     // 串联各个模块
     m_fileReader->SetListener(this);
@@ -53,20 +65,23 @@ Player::~Player() {
 }
 
 void Player::InitTaskPoolGLContext() {
-    m_taskPool->SubmitTask([this]() {
-        m_taskPoolGLContext.Initialize();
-        m_taskPoolGLContext.MakeCurrent();
-    });
+    m_taskPool->SubmitTask(
+        [this]() {
+            m_taskPoolGLContext.Initialize();
+            m_taskPoolGLContext.MakeCurrent();
+        },
+        TaskPriority::kHigh, TaskPool::kGLWorker);
 }
 
 void Player::DestroyTaskPoolGLContext() {
-    SyncNotifier notifier;
-    m_taskPool->SubmitTask([&]() {
-        m_taskPoolGLContext.MakeCurrent();
-        m_taskPoolGLContext.Destroy();
-        notifier.Notify();
-    });
-    notifier.Wait();
+    m_taskPool
+        ->Submit(
+            [this]() {
+                m_taskPoolGLContext.MakeCurrent();
+                m_taskPoolGLContext.Destroy();
+            },
+            TaskPriority::kHigh, TaskPool::kGLWorker)
+        .wait();
 }
 
 void Player::AttachDisplayView(std::shared_ptr<IVideoDisplayView> displayView) {
@@ -88,7 +103,9 @@ void Player::SetPlaybackListener(std::shared_ptr<IPlaybackListener> listener) {
 
 bool Player::Open(std::string& filePath) {
     if (!m_fileReader) return false;
-    return m_fileReader->Open(filePath);
+    if (!m_fileReader->Open(filePath)) return false;
+    ApplySyncClockType();
+    return true;
 }
 
 void Player::Play() {
@@ -108,15 +125,58 @@ void Player::Pause() {
     if (m_playbackListener) m_playbackListener->NotifyPlaybackPaused();
 }
 
-void Player::SeekTo(float progress) {
+void Player::SeekTo(float progress, SeekMode mode) {
     if (IsPlaying()) Pause();
     if (!m_fileReader) return;
-    m_fileReader->SeekTo(progress);
+    m_fileReader->SeekTo(progress, mode);
     m_avSynchronizer->Reset();
+    // 丢弃设备中尚未播出的旧数据，音频时钟在新数据播出前不可用
+    if (m_audioSpeaker) m_audioSpeaker->Stop();
 }
 
 bool Player::IsPlaying() { return m_isPlaying; }
 
+void Player::SetSyncClockType(SyncClockType type) {
+    m_syncClockType = type;
+    ApplySyncClockType();
+}
+
+void Player::SetPlaybackRate(float rate) {
+    rate = std::clamp(rate, kMinPlaybackRate, kMaxPlaybackRate);
+    m_playbackRate = rate;
+    m_avSynchronizer->SetPlaybackRate(rate);
+    m_audioPipeline->SetPlaybackRate(rate);
+    UpdateVideoSkipNonReferenceFrames();
+}
+
+float Player::GetPlaybackRate() { return m_playbackRate; }
+
+VideoPresentationStats Player::GetVideoPresentationStats() {
+    auto stats = m_avSynchronizer->GetPresentationStats();
+    stats.skippedFrames = m_fileReader->GetVideoSkippedFrameCount();
+    return stats;
+}
+
+void Player::UpdateVideoSkipNonReferenceFrames() {
+    // 高倍速时大部分帧会被抽掉，跳过非参考帧让解码跟上倍速
+    bool skip = m_videoLagging || m_playbackRate >= kSkipNonReferencePlaybackRate;
+    if (m_fileReader) m_fileReader->SetVideoSkipNonReferenceFrames(skip);
+}
+
+void Player::ApplySyncClockType() {
+    SyncClockType type = m_syncClockType;
+    if (type == SyncClockType::kAuto) {
+        // 没有音频流（或尚未打开文件）时无法以音频为准
+        type = m_fileReader && m_fileReader->GetAudioStream() ? SyncClockType::kAudio : SyncClockType::kExternal;
+    }
+    // 音频主时钟以设备实际播出的位置为准
+    m_avSynchronizer->SetMasterClock(
+        IMasterClock::Create(type, [speaker = std::weak_ptr<IAudioSpeaker>(m_audioSpeaker)]() {
+            auto audioSpeaker = speaker.lock();
+            return audioSpeaker ? audioSpeaker->GetPlaybackTimeStamp() : -1.0;
+        }));
+}
+
 std::shared_ptr<IVideoFilter> Player::AddVideoFilter(VideoFilterType type) {
     return m_videoPipeline ? m_videoPipeline->AddVideoFilter(type) : nullptr;
 }
@@ -128,6 +188,20 @@ void Player::RemoveVideoFilter(VideoFilterType type) {
 bool Player::StartRecording(const std::string& outputFilePath, int flags) {
     std::lock_guard<std::mutex> lock(m_fileWriterMutex);
     if (m_fileWriter) m_fileWriter->StopWriter();
+
+    // 没有滤镜时画面与源文件一致，直接复制数据包，省去读回和重新编码
+    if (!m_videoPipeline->HasVideoFilter()) {
+        m_fileWriter = std::shared_ptr<IFileWriter>(IFileWriter::CreateSoftware());
+        if (m_fileWriter->StartRemux(outputFilePath, m_fileReader->GetAudioStream(),
+                                     m_fileReader->GetVideoStream())) {
+            m_fileReader->SetPacketOutputEnabled(true);
+            m_isRecording = true;
+            return true;
+        }
+        // 源编码无法直接封装进 mp4 时回退到重新编码
+        std::cerr << "Stream copy recording is not available, re-encoding instead." << std::endl;
+    }
+
     m_fileWriter = std::shared_ptr<IFileWriter>(IFileWriter::Create(m_glContext));
 
     FileWriterParameters parameters;
@@ -138,6 +212,7 @@ bool Player::StartRecording(const std::string& outputFilePath, int flags) {
 }
 
 void Player::StopRecording() {
+    m_fileReader->SetPacketOutputEnabled(false);
     std::lock_guard<std::mutex> lock(m_fileWriterMutex);
     if (m_fileWriter) {
         m_fileWriter->StopWriter();
@@ -165,6 +240,16 @@ void Player::OnFileReaderNotifyVideoFinished() {
     if (m_avSynchronizer) m_avSynchronizer->NotifyVideoFinished();
 }
 
+void Player::OnFileReaderNotifyAudioPacket(std::shared_ptr<IAVPacket> packet) {
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyAudioPacket(packet);
+}
+
+void Player::OnFileReaderNotifyVideoPacket(std::shared_ptr<IAVPacket> packet) {
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyVideoPacket(packet);
+}
+
 // 继承自AVSynchronizer::Listener
 void Player::OnAVSynchronizerNotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
     if (m_audioPipeline) m_audioPipeline->NotifyAudioSamples(audioSamples);
@@ -182,6 +267,12 @@ void Player::OnAVSynchronizerNotifyVideoFinished() {
     if (m_videoPipeline) m_videoPipeline->NotifyVideoFinished();
 }
 
+void Player::OnAVSynchronizerNotifyVideoLagging(bool lagging) {
+    // 持续落后时解码器跳过非参考帧，从源头减少需要处理的帧
+    m_videoLagging = lagging;
+    UpdateVideoSkipNonReferenceFrames();
+}
+
 // 继承自IAudioPipeline::Listener
 void Player::OnAudioPipelineNotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
     if (m_audioSpeaker) m_audioSpeaker->PlayAudioSamples(audioSamples);
@@ -31,8 +31,12 @@ public:
     bool Open(std::string& filePath) override;
     void Play() override;
     void Pause() override;
-    void SeekTo(float progress) override;
+    void SeekTo(float progress, SeekMode mode) override;
     bool IsPlaying() override;
+    void SetSyncClockType(SyncClockType type) override;
+    void SetPlaybackRate(float rate) override;
+    float GetPlaybackRate() override;
+    VideoPresentationStats GetVideoPresentationStats() override;
 
     std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) override;
     void RemoveVideoFilter(VideoFilterType type) override;
@@ -43,6 +47,10 @@ public:
 
 private:
     void InitTaskPoolGLContext();
+    // 按当前设置与打开的文件创建主时钟
+    void ApplySyncClockType();
+    // 视频持续落后或高倍速播放时，解码器跳过非参考帧
+    void UpdateVideoSkipNonReferenceFrames();
     void DestroyTaskPoolGLContext();
 
     // 继承自IFileReader::Listener
@@ -50,12 +58,15 @@ private:
     void OnFileReaderNotifyVideoFrame(std::shared_ptr<IVideoFrame>) override;
     void OnFileReaderNotifyAudioFinished() override;
     void OnFileReaderNotifyVideoFinished() override;
+    void OnFileReaderNotifyAudioPacket(std::shared_ptr<IAVPacket>) override;
+    void OnFileReaderNotifyVideoPacket(std::shared_ptr<IAVPacket>) override;
 
     // 继承自AVSynchronizer::Listener
     void OnAVSynchronizerNotifyAudioSamples(std::shared_ptr<IAudioSamples>) override;
     void OnAVSynchronizerNotifyVideoFrame(std::shared_ptr<IVideoFrame>) override;
     void OnAVSynchronizerNotifyAudioFinished() override;
     void OnAVSynchronizerNotifyVideoFinished() override;
+    void OnAVSynchronizerNotifyVideoLagging(bool lagging) override;
 
     // 继承自IAudioPipeline::Listener
     void OnAudioPipelineNotifyAudioSamples(std::shared_ptr<IAudioSamples>) override;
@@ -97,6 +108,9 @@ private:
     std::shared_ptr<TaskPool> m_taskPool;
 
     std::atomic<bool> m_isPlaying{false};
+    std::atomic<SyncClockType> m_syncClockType{SyncClockType::kAuto};
+    std::atomic<float> m_playbackRate{1.0f};
+    std::atomic<bool> m_videoLagging{false};
     std::atomic<bool> m_isRecording{false};
 };
 
@@ -0,0 +1,146 @@
+#include "Transcoder.h"
+
+#include <iostream>
+
+#include "Define/BaseDef.h"
+
+namespace av {
+
+ITranscoder* ITranscoder::Create() { return new Transcoder(); }
+
+Transcoder::Transcoder() {
+    m_taskPool = std::make_shared<TaskPool>(1);
+
+    // 编码器可以直接读取 YUV 平面，只有添加滤镜时才转换为 RGBA
+    m_fileReader = std::shared_ptr<IFileReader>(IFileReader::Create());
+    m_fileReader->SetVideoYUVOutputEnabled(true);
+    m_fileReader->SetListener(this);
+
+    m_videoFilterChain = std::make_shared<CPUVideoFilterChain>();
+}
+
+Transcoder::~Transcoder() {
+    Stop();
+    m_fileReader->Stop();
+    // 等待已提交的视频处理任务执行完毕
+    m_taskPool = nullptr;
+
+    m_fileReader = nullptr;
+    m_fileWriter = nullptr;
+}
+
+void Transcoder::SetListener(ITranscoder::Listener* listener) {
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    m_listener = listener;
+}
+
+bool Transcoder::Open(const std::string& filePath) {
+    if (!m_fileReader) return false;
+    return m_fileReader->Open(filePath);
+}
+
+std::shared_ptr<IVideoFilter> Transcoder::AddVideoFilter(VideoFilterType type) {
+    return m_videoFilterChain->AddVideoFilter(type);
+}
+
+void Transcoder::RemoveVideoFilter(VideoFilterType type) { m_videoFilterChain->RemoveVideoFilter(type); }
+
+bool Transcoder::Start(const std::string& outputFilePath, int flags) {
+    if (m_isRunning) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+        m_fileWriter = std::shared_ptr<IFileWriter>(IFileWriter::CreateSoftware());
+        m_fileWriter->SetListener(this);
+
+        FileWriterParameters parameters;
+        parameters.width = m_fileReader->GetVideoWidth();
+        parameters.height = m_fileReader->GetVideoHeight();
+        if (!m_fileWriter->StartWriter(outputFilePath, parameters, flags)) {
+            std::cerr << "Transcoder failed to start writer: " << outputFilePath << std::endl;
+            m_fileWriter = nullptr;
+            return false;
+        }
+    }
+
+    m_isRunning = true;
+    m_fileReader->Start();
+    return true;
+}
+
+void Transcoder::Stop() {
+    if (!m_isRunning.exchange(false)) return;
+    m_fileReader->Pause();
+
+    {
+        std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+        if (m_fileWriter) {
+            // 中止时由这里通知，不再等待编码器冲刷
+            m_fileWriter->SetListener(nullptr);
+            m_fileWriter->StopWriter();
+        }
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    if (m_listener) m_listener->OnTranscoderNotifyFinished(false);
+}
+
+bool Transcoder::IsRunning() { return m_isRunning; }
+
+void Transcoder::ProcessVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    m_videoFilterChain->Process(videoFrame);
+
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyVideoFrame(videoFrame);
+}
+
+void Transcoder::NotifyProgress(int64_t pts, int32_t timebaseNum, int32_t timebaseDen) {
+    if (timebaseDen == 0) return;
+    float timeStamp = static_cast<float>(static_cast<double>(pts) * timebaseNum / timebaseDen);
+
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    if (m_listener) m_listener->OnTranscoderNotifyProgress(timeStamp, m_fileReader->GetDuration());
+}
+
+// 继承自IFileReader::Listener
+void Transcoder::OnFileReaderNotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
+    // 刷新标记只用于播放时清空下游队列，转码不会跳转
+    if (audioSamples->flags & static_cast<int>(AVFrameFlag::kFlush)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+        if (m_fileWriter) m_fileWriter->NotifyAudioSamples(audioSamples);
+    }
+    NotifyProgress(audioSamples->pts, audioSamples->timebaseNum, audioSamples->timebaseDen);
+}
+
+void Transcoder::OnFileReaderNotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    if (videoFrame->flags & static_cast<int>(AVFrameFlag::kFlush)) return;
+    m_taskPool->SubmitTask([this, videoFrame]() { ProcessVideoFrame(videoFrame); }, TaskPriority::kNormal,
+                           kVideoWorker);
+}
+
+void Transcoder::OnFileReaderNotifyAudioFinished() {
+    std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+    if (m_fileWriter) m_fileWriter->NotifyAudioFinished();
+}
+
+void Transcoder::OnFileReaderNotifyVideoFinished() {
+    // 与视频帧走同一线程，保证结束标记在最后一帧之后
+    m_taskPool->SubmitTask(
+        [this]() {
+            std::lock_guard<std::mutex> lock(m_fileWriterMutex);
+            if (m_fileWriter) m_fileWriter->NotifyVideoFinished();
+        },
+        TaskPriority::kNormal, kVideoWorker);
+}
+
+// 继承自IFileWriter::Listener，在编码线程上调用
+void Transcoder::OnFileWriterNotifyFinished() {
+    if (!m_isRunning.exchange(false)) return;
+
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    if (m_listener) m_listener->OnTranscoderNotifyFinished(true);
+}
+
+}  // namespace av
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Core/TaskPool.h"
+#include "ITranscoder.h"
+#include "Interface/IFileReader.h"
+#include "Interface/IFileWriter.h"
+#include "VideoFilter/CPUVideoFilter.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace av {
+
+// 不经过音画同步和实时播放，解码速度只受编码器消费速度限制
+// 一次 Open 对应一次 Start
+class Transcoder : public ITranscoder, public IFileReader::Listener, public IFileWriter::Listener {
+public:
+    Transcoder();
+    ~Transcoder() override;
+
+    void SetListener(ITranscoder::Listener* listener) override;
+    bool Open(const std::string& filePath) override;
+
+    std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) override;
+    void RemoveVideoFilter(VideoFilterType type) override;
+
+    bool Start(const std::string& outputFilePath, int flags) override;
+    void Stop() override;
+    bool IsRunning() override;
+
+private:
+    void ProcessVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
+    void NotifyProgress(int64_t pts, int32_t timebaseNum, int32_t timebaseDen);
+
+    // 继承自IFileReader::Listener
+    void OnFileReaderNotifyAudioSamples(std::shared_ptr<IAudioSamples>) override;
+    void OnFileReaderNotifyVideoFrame(std::shared_ptr<IVideoFrame>) override;
+    void OnFileReaderNotifyAudioFinished() override;
+    void OnFileReaderNotifyVideoFinished() override;
+
+    // 继承自IFileWriter::Listener
+    void OnFileWriterNotifyFinished() override;
+
+private:
+    ITranscoder::Listener* m_listener{nullptr};
+    std::recursive_mutex m_listenerMutex;
+
+    std::shared_ptr<IFileReader> m_fileReader;
+    std::shared_ptr<CPUVideoFilterChain> m_videoFilterChain;
+
+    std::shared_ptr<IFileWriter> m_fileWriter;
+    std::mutex m_fileWriterMutex;
+
+    // 单线程执行视频滤镜，任务固定在同一线程上按提交顺序执行
+    std::shared_ptr<TaskPool> m_taskPool;
+    static constexpr int kVideoWorker = 0;
+
+    std::atomic<bool> m_isRunning{false};
+};
+
+}  // namespace av
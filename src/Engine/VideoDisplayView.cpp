@@ -1,4 +1,5 @@
 #include "VideoDisplayView.h"
+#include "Utils/GLFence.h"
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLContext>
 #include <QDebug>
@@ -13,10 +14,12 @@ static const char* vertexShaderSource = R"(
 
     out vec2 TexCoord;
 
+    uniform bool flipY;
+
     void main()
     {
         gl_Position = vec4(aPos, 1.0);
-        TexCoord = aTexCoord;
+        TexCoord = flipY ? vec2(aTexCoord.x, 1.0 - aTexCoord.y) : aTexCoord;
     }
 )";
 
@@ -43,6 +46,8 @@ void VideoDisplayView::SetTaskPool(std::shared_ptr<TaskPool> taskPool) { m_taskP
 
 void VideoDisplayView::InitializeGL() {
     m_shaderProgram = GLUtils::CompileAndLinkProgram(vertexShaderSource, fragmentShaderSource);
+    m_texturePool = GLTexturePool::Create();
+    m_flipYLocation = glGetUniformLocation(m_shaderProgram, "flipY");
 
     float vertices[] = {// positions         // texture coords
                         1.0f,  1.0f,  0.0f, 1.0f, 1.0f, 1.0f,  -1.0f, 0.0f, 1.0f, 0.0f,
@@ -86,21 +91,26 @@ void VideoDisplayView::Render(int width, int height, float red, float green, flo
 
     glClearColor(red, green, blue, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+    GLTexturePool::CollectGarbage();
 
     if (!m_videoFrame) return;
+    // YUV 帧只能经由 VideoPipeline 转换后显示
+    if (!m_videoFrame->textureId && !m_videoFrame->data) return;
 
     if (!m_videoFrame->textureId) {
-        glGenTextures(1, &m_videoFrame->textureId);
-        glBindTexture(GL_TEXTURE_2D, m_videoFrame->textureId);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_videoFrame->width, m_videoFrame->height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                     m_videoFrame->data.get());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    } else {
-        glBindTexture(GL_TEXTURE_2D, m_videoFrame->textureId);
+        // 纹理随帧释放归还到池中，下一帧直接复用
+        m_texturePool->AcquireForFrame(*m_videoFrame);
+        m_pixelUploader.Upload(m_videoFrame->textureId, m_videoFrame->width, m_videoFrame->height,
+                               m_videoFrame->data.get());
+        m_videoFrame->textureFlipped = true;
+    } else if (m_videoFrame->fence) {
+        // 纹理在渲染线程中生成，采样前让本上下文的 GPU 命令等待其完成
+        m_videoFrame->fence->WaitOnGPU();
     }
 
     glUseProgram(m_shaderProgram);
+    // 行序与 OpenGL 相反的纹理在采样时翻转，省去单独的翻转绘制
+    glUniform1i(m_flipYLocation, m_videoFrame->textureFlipped ? 1 : 0);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, m_videoFrame->textureId);
@@ -141,19 +151,23 @@ void VideoDisplayView::Render(int width, int height, float red, float green, flo
     glBindVertexArray(0);
 
     glBindTexture(GL_TEXTURE_2D, 0);
+    // 纹理归还到渲染线程的池中后，再次写入前要等待本次采样完成
+    m_videoFrame->SetConsumerFence(this, GLFence::Create());
 }
 
 void VideoDisplayView::Clear() {
-    SyncNotifier notifier;
-    if (m_taskPool) {
-        m_taskPool->SubmitTask([&]() {
-            if (m_shaderProgram > 0) glDeleteProgram(m_shaderProgram);
-            std::lock_guard<std::mutex> lock(m_videoFrameMutex);
-            m_videoFrame = nullptr;
-            notifier.Notify();
-        });
-    }
-    notifier.Wait();
+    if (!m_taskPool) return;
+    m_taskPool
+        ->Submit(
+            [this]() {
+                if (m_shaderProgram > 0) glDeleteProgram(m_shaderProgram);
+                std::lock_guard<std::mutex> lock(m_videoFrameMutex);
+                m_videoFrame = nullptr;
+                if (m_texturePool) m_texturePool->Clear();
+                m_pixelUploader.Destroy();
+            },
+            TaskPriority::kHigh, TaskPool::kGLWorker)
+        .wait();
 }
 
 }  // namespace av
\ No newline at end of file
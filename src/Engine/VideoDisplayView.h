@@ -2,6 +2,8 @@
 
 #include "Core/SyncNotifier.h"
 #include "Core/TaskPool.h"
+#include "Utils/GLPixelUploader.h"
+#include "Utils/GLTexturePool.h"
 #include "Utils/GLUtils.h"
 #include <iostream>
 
@@ -36,7 +38,12 @@ private:
     std::shared_ptr<IVideoFrame> m_videoFrame;
     std::mutex m_videoFrameMutex;
 
+    // 系统内存中的 RGBA 帧上传时使用的纹理池
+    std::shared_ptr<GLTexturePool> m_texturePool;
+    GLPixelUploader m_pixelUploader;
+
     unsigned int m_shaderProgram{0};
+    int m_flipYLocation{-1};
     unsigned int m_VAO{0};
     unsigned int m_VBO{0};
     unsigned int m_EBO{0};
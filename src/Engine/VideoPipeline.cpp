@@ -1,4 +1,7 @@
 #include "VideoPipeline.h"
+#include "VideoFilter/FusedVideoFilter.h"
+#include "VideoFilter/YUVConvertFilter.h"
+#include "Utils/GLFence.h"
 #include <QOpenGLContext>
 #include <QDebug>
 
@@ -39,10 +42,15 @@ void VideoPipeline::RemoveVideoFilter(VideoFilterType type) {
     }
 }
 
+bool VideoPipeline::HasVideoFilter() {
+    std::lock_guard<std::mutex> lock(m_videoFilterMutex);
+    return !m_videoFilters.empty();
+}
+
 void VideoPipeline::NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
-    std::lock_guard<std::mutex> lock(m_queueMutex);
-    m_frameQueue.push_back(videoFrame);
-    m_queueCondVar.notify_one();
+    // 队列满时等待渲染线程，不丢帧；只有停止时放弃
+    m_frameQueue.Push(std::move(videoFrame), [this]() { return m_abort.load(); });
+    m_notifier.Notify();
 }
 
 void VideoPipeline::NotifyVideoFinished() {
@@ -51,69 +59,84 @@ void VideoPipeline::NotifyVideoFinished() {
 }
 
 void VideoPipeline::Stop() {
-    {
-        std::lock_guard<std::mutex> lock(m_queueMutex);
-        m_abort = true;
-        m_queueCondVar.notify_all();
-    }
+    m_abort = true;
+    m_notifier.Notify();
+    m_frameQueue.WakeProducer();
     if (m_thread->joinable()) m_thread->join();
 }
 
 void VideoPipeline::PrepareTempTexture(int width, int height) {
-    if (m_tempTexture.id == 0) {
-        glGenTextures(1, &m_tempTexture.id);
-        glBindTexture(GL_TEXTURE_2D, m_tempTexture.id);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        m_tempTexture.width = width;
-        m_tempTexture.height = height;
-    } else if (m_tempTexture.width != width || m_tempTexture.height != height) {
-        glBindTexture(GL_TEXTURE_2D, m_tempTexture.id);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        m_tempTexture.width = width;
-        m_tempTexture.height = height;
-    }
+    if (m_tempTexture.id != 0 && m_tempTexture.width == width && m_tempTexture.height == height) return;
+
+    // 尺寸变化时归还旧纹理，其它帧仍可能复用该尺寸
+    m_texturePool->Release(m_tempTexture.id, m_tempTexture.width, m_tempTexture.height);
+    m_tempTexture.id = m_texturePool->Acquire(width, height);
+    m_tempTexture.width = width;
+    m_tempTexture.height = height;
 }
 
 void VideoPipeline::PrepareVideoFrame(std::shared_ptr<IVideoFrame> frame) {
-    glGenTextures(1, &frame->textureId);
-    glBindTexture(GL_TEXTURE_2D, frame->textureId);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, frame->width, frame->height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                 frame->data.get());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    // 垂直翻转画面
-    if (!m_flipVerticalFilter) {
-        m_flipVerticalFilter = std::shared_ptr<VideoFilter>(VideoFilter::Create(VideoFilterType::kFlipVertical));
+    if (frame->format != VideoPixelFormat::kRGBA) {
+        PrepareYUVVideoFrame(frame);
+        return;
     }
-    if (m_flipVerticalFilter) {
-        m_flipVerticalFilter->Render(frame, m_tempTexture.id);
+
+    // 复用池中同尺寸纹理，只更新内容
+    m_texturePool->AcquireForFrame(*frame);
+    m_pixelUploader.Upload(frame->textureId, frame->width, frame->height, frame->data.get());
+    // 行序保持系统内存中的顺序，由后续的滤镜、显示和编码在采样时翻转
+    frame->textureFlipped = true;
+}
+
+void VideoPipeline::PrepareYUVVideoFrame(std::shared_ptr<IVideoFrame> frame) {
+    if (!frame->avFrame) return;
+
+    m_texturePool->AcquireForFrame(*frame);
+    if (!m_yuvConvertFilter) {
+        m_yuvConvertFilter = std::make_shared<YUVConvertFilter>();
     }
+    m_yuvConvertFilter->Render(frame, frame->textureId);
 
-    std::swap(frame->textureId, m_tempTexture.id);
+    // 平面数据已上传，尽早归还解码器的帧缓冲
+    frame->avFrame = nullptr;
 }
 
 void VideoPipeline::RenderVideoFilter(std::shared_ptr<IVideoFrame> frame) {
-    PrepareTempTexture(frame->width, frame->height);
-
     std::lock_guard<std::mutex> lock(m_videoFilterMutex);
     m_removedVideoFilters.clear();
-    if (m_videoFilters.empty()) return;
-
-    auto inputTexture = frame->textureId;
-    auto outputTexture = m_tempTexture.id;
-
-    auto filterRenderCount = 0;
-    for (auto& filter : m_videoFilters) {
-        if (filter->Render(frame, outputTexture)) {
-            ++filterRenderCount;
-            std::swap(inputTexture, outputTexture);
+    std::vector<std::shared_ptr<VideoFilter>> chain(m_videoFilters.begin(), m_videoFilters.end());
+
+    // 相邻的逐像素滤镜合并为一次绘制，其余滤镜单独绘制；每次绘制后帧纹理与临时纹理交换
+    for (size_t begin = 0; begin < chain.size();) {
+        size_t end = begin;
+        while (end < chain.size() && chain[end]->IsFusable()) ++end;
+
+        std::shared_ptr<VideoFilter> filter;
+        if (end - begin >= 2) {
+            std::vector<std::shared_ptr<VideoFilter>> fusedChain(chain.begin() + begin, chain.begin() + end);
+            filter = GetFusedVideoFilter(fusedChain);
+        } else {
+            end = begin + 1;
+            filter = chain[begin];
+        }
+        if (filter && filter->Render(frame, m_tempTexture.id)) {
+            std::swap(frame->textureId, m_tempTexture.id);
+            // 滤镜按纹理坐标翻转采样，输出已是 OpenGL 行序
+            frame->textureFlipped = false;
         }
+        begin = end;
     }
+}
+
+std::shared_ptr<VideoFilter> VideoPipeline::GetFusedVideoFilter(const std::vector<std::shared_ptr<VideoFilter>>& filters) {
+    auto key = FusedVideoFilter::GetChainKey(filters);
+    auto it = m_fusedVideoFilters.find(key);
+    if (it != m_fusedVideoFilters.end()) return it->second;
 
-    if (filterRenderCount % 2 == 1) std::swap(frame->textureId, m_tempTexture.id);
+    // 每种滤镜组合只编译一次着色器
+    auto filter = std::make_shared<FusedVideoFilter>(filters);
+    m_fusedVideoFilters.emplace(key, filter);
+    return filter;
 }
 
 void VideoPipeline::ThreadLoop() {
@@ -123,31 +146,40 @@ void VideoPipeline::ThreadLoop() {
     unsigned int fbo{0};
     glGenFramebuffers(1, &fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    m_texturePool = GLTexturePool::Create();
+    // 启动时预热滤镜着色器，之后添加滤镜只需加载缓存的程序二进制
+    VideoFilter::PrewarmPrograms();
 
     for (;;) {
         std::shared_ptr<IVideoFrame> frame;
-        {
-            std::unique_lock<std::mutex> lock(m_queueMutex);
-            m_queueCondVar.wait(lock, [this] { return m_abort || !m_frameQueue.empty(); });
-            if (m_abort) break;
-            frame = m_frameQueue.front();
-            m_frameQueue.pop_front();
+        while (!m_abort && !m_frameQueue.TryPop(frame)) {
+            m_notifier.Wait();
         }
+        if (m_abort) break;
 
         if (frame) {
+            // 滤镜渲染到临时纹理
+            PrepareTempTexture(frame->width, frame->height);
             PrepareVideoFrame(frame);
             RenderVideoFilter(frame);
-            glFinish();
+            // 不等待 GPU 完成，使用者采样纹理前再等待栅栏，多帧可以同时在 GPU 中处理
+            frame->fence = GLFence::Create();
+            GLFence::CollectGarbage();
+            GLTexturePool::CollectGarbage();
 
             std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
             if (m_listener) m_listener->OnVideoPipelineNotifyVideoFrame(frame);
         }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(m_queueMutex);
-        m_frameQueue.clear();
-    }
+    m_frameQueue.Clear();
+
+    m_texturePool->Release(m_tempTexture.id, m_tempTexture.width, m_tempTexture.height);
+    m_tempTexture = TextureInfo();
+    m_texturePool->Clear();
+    // 滤镜持有 GL 对象，需在上下文销毁前释放
+    m_fusedVideoFilters.clear();
+    m_pixelUploader.Destroy();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glDeleteFramebuffers(1, &fbo);
@@ -2,8 +2,15 @@
 
 #include "Interface/IVideoPipeline.h"
 #include "VideoFilter/VideoFilter.h"
+#include "Core/SPSCQueue.h"
+#include "Core/SyncNotifier.h"
+#include "Utils/GLPixelUploader.h"
+#include "Utils/GLTexturePool.h"
 #include <thread>
-#include <condition_variable>
+#include <atomic>
+#include <list>
+#include <unordered_map>
+#include <vector>
 #include <mutex>
 
 
@@ -17,6 +24,7 @@ public:
     // 添加和移除滤镜
     std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) override;
     void RemoveVideoFilter(VideoFilterType type) override;
+    bool HasVideoFilter() override;
 
     void SetListener(Listener* listener) override;
 
@@ -28,22 +36,28 @@ private:
     // 持续地接收、处理视频帧，并应用各种 OpenGL 滤镜效果
     void ThreadLoop();
 
-    // 将 CPU 内存中的视频帧数据转换为 GPU 可用的纹理，并且在必要时对视频帧进行垂直翻转，为后续的滤镜渲染做准备。
+    // 将 CPU 内存中的视频帧数据转换为 GPU 可用的纹理，为后续的滤镜渲染做准备
+    // RGBA 数据按原行序上传并标记 textureFlipped，不单独绘制翻转
     void PrepareVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
-    // 初始化或调整一个用于临时存储渲染结果的 OpenGL 纹理
+    // 将 YUV 各平面上传为纹理，并在着色器中转换为 RGBA 纹理（同时完成垂直翻转）
+    void PrepareYUVVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
+    // 从纹理池中准备一个与视频帧同尺寸的临时纹理，用于存储滤镜的渲染结果
     void PrepareTempTexture(int width, int height);
 
     // 将一系列预设的视频滤镜（VideoFilter）按顺序应用到视频帧上
     // 管理 OpenGL 纹理的输入和输出，实现多个视频滤镜的串联应用
     void RenderVideoFilter(std::shared_ptr<IVideoFrame> videoFrame);
+    // 取得一段相邻可合并滤镜对应的合并滤镜，已编译的按滤镜组合缓存
+    std::shared_ptr<VideoFilter> GetFusedVideoFilter(const std::vector<std::shared_ptr<VideoFilter>>& filters);
 
 private:
     GLContext m_sharedGLContext;
 
-    std::mutex m_queueMutex;
-    std::list<std::shared_ptr<IVideoFrame>> m_frameQueue;
+    // 同步线程 -> 渲染线程，队列满时同步线程等待（反压）
+    static constexpr size_t kFrameQueueCapacity = 64;
+    SPSCQueue<std::shared_ptr<IVideoFrame>> m_frameQueue{kFrameQueueCapacity};
 
-    std::shared_ptr<VideoFilter> m_flipVerticalFilter;  // 垂直翻转滤镜
+    std::shared_ptr<VideoFilter> m_yuvConvertFilter;    // YUV 转 RGBA
 
     std::recursive_mutex m_listenerMutex;
     IVideoPipeline::Listener* m_listener{nullptr};
@@ -52,13 +66,18 @@ private:
     std::mutex m_videoFilterMutex;
     std::list<std::shared_ptr<VideoFilter>> m_videoFilters;
     std::list<std::shared_ptr<VideoFilter>> m_removedVideoFilters;
+    // 滤镜组合 -> 合并滤镜，只在渲染线程中访问
+    std::unordered_map<std::string, std::shared_ptr<VideoFilter>> m_fusedVideoFilters;
 
 
     // 多线程相关
-    std::condition_variable m_queueCondVar;
+    SyncNotifier m_notifier;
+    std::atomic<bool> m_abort{false};
     std::shared_ptr<std::thread> m_thread;
-    bool m_abort{false};
 
+    // 帧纹理和临时纹理都从池中分配，帧与临时纹理交换后由帧在释放时归还
+    std::shared_ptr<GLTexturePool> m_texturePool;
+    GLPixelUploader m_pixelUploader;  // RGBA 帧经像素缓冲区异步上传
     struct TextureInfo {
         unsigned int id{0};
         int width{0};
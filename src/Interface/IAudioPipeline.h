@@ -1,7 +1,6 @@
 #pragma once
 
 #include "Define/IAudioSamples.h"
-#include "IGLContext.h"
 
 namespace av {
 
@@ -15,6 +14,8 @@ struct IAudioPipeline {
     virtual void SetListener(Listener* listener) = 0;
     virtual void NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) = 0;
     virtual void NotifyAudioFinished() = 0;
+    // 播放倍速，非 1 倍速时对音频做变速不变调处理
+    virtual void SetPlaybackRate(float rate) = 0;
 
     virtual ~IAudioPipeline() = default;
 
@@ -8,6 +8,9 @@ namespace av {
 struct IAudioSpeaker {
     virtual void PlayAudioSamples(std::shared_ptr<IAudioSamples> samples) = 0;
     virtual void Stop() = 0;
+    // 设备当前实际播出位置对应的时间戳（秒），已扣除设备与内部缓冲中尚未播出的数据；
+    // 暂无可用时钟（未开始播放、Stop 后新数据尚未播出）时返回负数。任意线程可调用
+    virtual double GetPlaybackTimeStamp() = 0;
     virtual ~IAudioSpeaker() = default;
 
     static IAudioSpeaker* Create(unsigned int channels, unsigned int sampleRate);
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "Define/IAVPacket.h"
 #include "Define/IAudioSamples.h"
 #include "Define/IVideoFrame.h"
+#include "Core/FrameBufferPool.h"
+#include "Define/DecodeThreadingParameters.h"
+#include "Define/SeekMode.h"
 
 struct AVStream;
 namespace av {
@@ -12,13 +16,16 @@ struct IFileReader {
         virtual void OnFileReaderNotifyVideoFrame(std::shared_ptr<IVideoFrame>) = 0;
         virtual void OnFileReaderNotifyAudioFinished() = 0;
         virtual void OnFileReaderNotifyVideoFinished() = 0;
+        // 解码前的压缩数据包（含刷新标记），仅在开启数据包输出后通知，用于不重新编码的录制
+        virtual void OnFileReaderNotifyAudioPacket(std::shared_ptr<IAVPacket>) {}
+        virtual void OnFileReaderNotifyVideoPacket(std::shared_ptr<IAVPacket>) {}
         virtual ~Listener() = default;
     };
 
     virtual void SetListener(Listener* listener) = 0;
     virtual bool Open(const std::string& filePath) = 0;
 
-    virtual void SeekTo(float progress) = 0;
+    virtual void SeekTo(float progress, SeekMode mode = SeekMode::kExact) = 0;
 
     virtual void Start() = 0;
     virtual void Pause() = 0;
@@ -28,6 +35,22 @@ struct IFileReader {
     virtual int GetVideoWidth() = 0;
     virtual int GetVideoHeight() = 0;
 
+    // 源文件中的音视频流，不存在时返回 nullptr，仅在 Open 之后有效
+    virtual AVStream* GetAudioStream() = 0;
+    virtual AVStream* GetVideoStream() = 0;
+    virtual void SetPacketOutputEnabled(bool enabled) = 0;
+
+    // 视频帧是否以 YUV 平面输出（由下游负责颜色转换）
+    virtual void SetVideoYUVOutputEnabled(bool enabled) = 0;
+    virtual FrameBufferPoolStats GetFrameBufferPoolStats() = 0;
+
+    // 视频解码线程配置，需在 Open 之前设置
+    virtual void SetVideoDecodeThreading(const DecodeThreadingParameters& parameters) = 0;
+    virtual int GetVideoDecodeThreadCount() = 0;
+
+    // 视频解码是否跳过非参考帧，用于播放持续落后时降低负载
+    virtual void SetVideoSkipNonReferenceFrames(bool enabled) = 0;
+    virtual uint64_t GetVideoSkippedFrameCount() = 0;
 
     virtual ~IFileReader() = default;
     static IFileReader* Create();
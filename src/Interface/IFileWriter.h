@@ -1,25 +1,52 @@
 #pragma once
 
 #include "Define/FileWriterParameters.h"
+#include "Define/IAVPacket.h"
 #include "Define/IAudioSamples.h"
 #include "Define/IVideoFrame.h"
-#include "IGLContext.h"
+#include "Define/VideoReadbackStats.h"
+
+#include <string>
+
+struct AVStream;
 
 namespace av {
 
+class GLContext;
+
 struct IFileWriter {
+    struct Listener {
+        // 音视频编码器均已冲刷完毕
+        virtual void OnFileWriterNotifyFinished() = 0;
+        virtual ~Listener() = default;
+    };
+
+    virtual void SetListener(Listener* listener) = 0;
+
     virtual bool StartWriter(const std::string& outputFilePath, FileWriterParameters& parameters, int flags) = 0;
     virtual void StopWriter() = 0;
 
+    // 不解码也不重新编码，直接把源数据包写入文件；之后只接收 NotifyAudioPacket / NotifyVideoPacket
+    virtual bool StartRemux(const std::string& outputFilePath, const AVStream* audioStream,
+                            const AVStream* videoStream) = 0;
+    virtual void NotifyAudioPacket(std::shared_ptr<IAVPacket> packet) = 0;
+    virtual void NotifyVideoPacket(std::shared_ptr<IAVPacket> packet) = 0;
+
     virtual void NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) = 0;
     virtual void NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) = 0;
 
     virtual void NotifyAudioFinished() = 0;
     virtual void NotifyVideoFinished() = 0;
 
+    // 视频编码前纹理读回的阻塞统计
+    virtual VideoReadbackStats GetVideoReadbackStats() = 0;
+
     virtual ~IFileWriter() = default;
 
+    // 从 OpenGL 纹理读回后编码
     static IFileWriter* Create(GLContext& glContext);
+    // 直接编码系统内存中的 RGBA / YUV 帧，不依赖 OpenGL
+    static IFileWriter* CreateSoftware();
 };
 
-}  // namespace av
\ No newline at end of file
+}  // namespace av
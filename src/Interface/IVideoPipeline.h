@@ -16,6 +16,7 @@ struct IVideoPipeline {
 
     virtual std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type) = 0;
     virtual void RemoveVideoFilter(VideoFilterType type) = 0;
+    virtual bool HasVideoFilter() = 0;
 
     virtual void SetListener(Listener* listener) = 0;
 
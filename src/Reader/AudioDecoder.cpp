@@ -1,5 +1,7 @@
 #include "AudioDecoder.h"
 
+#include <cassert>
+
 namespace av {
 
 AudioDecoder::AudioDecoder(unsigned int channels, unsigned int sampleRate) : 
@@ -36,31 +38,42 @@ void AudioDecoder::Stop() {
 
 void AudioDecoder::ThreadLoop() {
     while (true) {
-        m_notifier.Wait(100);
+        // 无超时等待：新 packet、下游归还资源、启动/停止都会唤醒线程
+        m_notifier.Wait();
         if (m_abort) {
             break;
         }
+        if (m_clearRequested.exchange(false)) {
+            DiscardPackets();
+        }
+        // 有输入且下游有空闲资源时，尽可能多地连续解码
         CheckFlushPacket();
-        if (!m_paused && m_pipelineResourceCount > 0) {
-            DecodeAVPacket();
+        while (!m_abort && !m_paused && m_pipelineResourceCount > 0 && DecodeAVPacket()) {
+            CheckFlushPacket();
         }
     }
     // 线程结束时清空 packet 队列
-    {
-        std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-        m_packetQueue.clear();
-    }
+    DiscardPackets();
 }
 
 void AudioDecoder::CheckFlushPacket() {
-    std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-    if (m_packetQueue.empty()) {
-        return;
-    }
-    auto packet = m_packetQueue.front();
-    if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-        m_packetQueue.pop_front();
-        avcodec_flush_buffers(m_codecContext);
+    // 有待处理的刷新包时，丢弃刷新包之前的所有 packet
+    while (m_pendingFlushCount > 0) {
+        auto front = m_packetQueue.Front();
+        if (!front) return;
+
+        bool isFlush = (*front)->flags & static_cast<int>(AVFrameFlag::kFlush);
+        int64_t discardBeforePts = (*front)->discardBeforePts;
+        m_packetQueue.Pop();
+        if (!isFlush) continue;
+
+        m_pendingFlushCount--;
+        m_discardBeforePts = discardBeforePts;
+        {
+            // SetStream 可能在其它线程中替换解码上下文
+            std::lock_guard<std::mutex> lock(m_codecContextMutex);
+            if (m_codecContext) avcodec_flush_buffers(m_codecContext);
+        }
 
         auto audioSamples = std::make_shared<IAudioSamples>();
         audioSamples->flags |= static_cast<int>(AVFrameFlag::kFlush);
@@ -82,11 +95,9 @@ void AudioDecoder::SetStream(AVStream* stream) {
     if (stream == nullptr) {
         return;
     }
-    {
-        // 清空包队列
-        std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-        m_packetQueue.clear();
-    }
+    // 清空包队列，队列只能由解码线程消费，这里只发出清空请求
+    m_clearRequested = true;
+    m_notifier.Notify();
 
     std::lock_guard<std::mutex> lock(m_codecContextMutex);
     CleanupContext();
@@ -185,32 +196,44 @@ void AudioDecoder::SetStream(AVStream* stream) {
 // ========================================================================
 
 
-void AudioDecoder::DecodeAVPacket() {
+bool AudioDecoder::DecodeAVPacket() {
     // 取出队列中的 packet
     std::shared_ptr<IAVPacket> packet;
-    {
-        std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-        if (m_packetQueue.empty()) {
-            return;
-        }
-        packet = m_packetQueue.front();
-        m_packetQueue.pop_front();
+    // 刷新包交给 CheckFlushPacket 处理
+    if (m_pendingFlushCount > 0) {
+        return false;
+    }
+    if (!m_packetQueue.TryPop(packet)) {
+        return false;
+    }
+    // SetStream 在其它线程中释放并重建解码与重采样上下文，使用期间持有锁
+    std::lock_guard<std::mutex> lock(m_codecContextMutex);
+    bool isEndOfStream = packet->flags & static_cast<int>(AVFrameFlag::kEOS);
+    if (!m_codecContext) {
+        if (isEndOfStream) NotifyEndOfStream();
+        return true;
     }
-    // 将 packet 放入解码器
-    if (packet->avPacket && avcodec_send_packet(m_codecContext, packet->avPacket) < 0) {
+    // 将 packet 放入解码器，结束包送入空 packet 取出缓存中剩余的帧
+    if (isEndOfStream) {
+        avcodec_send_packet(m_codecContext, nullptr);
+    } else if (packet->avPacket && avcodec_send_packet(m_codecContext, packet->avPacket) < 0) {
         std::cerr << "Error sending audio packet for decoding." << std::endl;
-        return;
+        return true;
     }
 
     // 定义 frame 存放解码后的数据
     AVFrame* frame = av_frame_alloc();
     if (!frame) {
         std::cerr << "allocate audio frame fail." << std::endl;
-        return;
+        return true;
     }
 
     // 对解码器中的数据进行解码，放到 frame 直到解码器为空
     while (avcodec_receive_frame(m_codecContext, frame) >= 0) {
+        // 精确跳转时目标之前的数据在重采样前直接丢弃
+        if (ShouldDiscardFrame(frame)) {
+            continue;
+        }
         // 重采样后的样本数量
         int dst_nb_samples = 
             av_rescale_rnd(swr_get_delay(m_swrContext, m_codecContext->sample_rate) + frame->nb_samples,
@@ -227,7 +250,7 @@ void AudioDecoder::DecodeAVPacket() {
             std::cerr << "Error while converting." << std::endl;
             av_free(buffer);
             av_frame_free(&frame);
-            return;
+            return true;
         }
 
         // 将原始数据 frame，即 PCM 进行封装
@@ -250,22 +273,63 @@ void AudioDecoder::DecodeAVPacket() {
             m_listener->OnNotifyAudioSamples(samples);
         }
     }
+    av_frame_free(&frame);
+    if (isEndOfStream) {
+        NotifyEndOfStream();
+    }
+    return true;
+}
+
+void AudioDecoder::NotifyEndOfStream() {
+    auto audioSamples = std::make_shared<IAudioSamples>();
+    audioSamples->flags |= static_cast<int>(AVFrameFlag::kEOS);
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    if (m_listener) m_listener->OnNotifyAudioSamples(audioSamples);
 }
 
 
+bool AudioDecoder::ShouldDiscardFrame(const AVFrame* frame) {
+    if (m_discardBeforePts == AV_NOPTS_VALUE || frame->pts == AV_NOPTS_VALUE || frame->sample_rate <= 0) {
+        return false;
+    }
+    int64_t duration = av_rescale_q(frame->nb_samples, AVRational{1, frame->sample_rate}, m_timeBase);
+    bool beforeTarget = frame->pts + duration <= m_discardBeforePts;
+    if (!beforeTarget) {
+        m_discardBeforePts = AV_NOPTS_VALUE;
+    }
+    return beforeTarget;
+}
+
 void AudioDecoder::Decode(std::shared_ptr<IAVPacket> packet) {
     if (packet == nullptr) {
         return;
     }
-    std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-    if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-        m_packetQueue.clear();
+    // 刷新包之前的 packet 由解码线程丢弃，先计数再入队，保证解码线程看到刷新包时计数已生效
+    bool isFlush = packet->flags & static_cast<int>(AVFrameFlag::kFlush);
+    if (isFlush) {
+        m_pendingFlushCount++;
+    }
+    bool pushed = m_packetQueue.TryPush(packet);
+    // 容量覆盖解复用器的积压上限，不会失败；丢弃 packet 会破坏解码直到下一个关键帧
+    assert(pushed && "packet queue overflow");
+    if (!pushed) {
+        if (isFlush) {
+            m_pendingFlushCount--;
+        }
+        std::cerr << "Audio packet queue is full, packet dropped." << std::endl;
     }
-    // m_packetQueue.push_back(packet);
-    m_packetQueue.emplace_back(packet);
     m_notifier.Notify();
 }
 
+void AudioDecoder::DiscardPackets() {
+    std::shared_ptr<IAVPacket> packet;
+    while (m_packetQueue.TryPop(packet)) {
+        if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
+            m_pendingFlushCount--;
+        }
+    }
+}
+
 void AudioDecoder::ReleaseAudioPipelineResource() {
     m_pipelineResourceCount++;
     m_notifier.Notify();
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Interface/IAudioDecoder.h"
+#include "Interface/IDeMuxer.h"
 #include "Core/SyncNotifier.h"
+#include "Core/SPSCQueue.h"
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
@@ -34,13 +36,19 @@ public:
 
 private:
     // bool DecodeAVPacket(AVPacket* packet);
-    // 对 que 中的 packet 进行解码
-    void DecodeAVPacket();
+    // 对 que 中的 packet 进行解码，队列为空时返回 false
+    bool DecodeAVPacket();
 
     // 刷新包
     void CheckFlushPacket();
+    // 丢弃队列中所有 packet，只能在解码线程调用
+    void DiscardPackets();
     void CleanupContext();
 
+    // 向上层发送结束标记
+    void NotifyEndOfStream();
+    // 精确跳转时判断帧是否早于目标时间
+    bool ShouldDiscardFrame(const AVFrame* frame);
     void ReleaseAudioPipelineResource();
 
     // 线程相关
@@ -54,9 +62,15 @@ private:
     IAudioDecoder::Listener* m_listener{nullptr};
     std::recursive_mutex m_listenerMutex;
 
-    // packet 包队列
-    std::mutex m_packetQueueMutex;
-    std::list<std::shared_ptr<IAVPacket>> m_packetQueue;
+    // packet 包队列，生产者为解复用线程，消费者为解码线程
+    // 解复用器限制了每路流未释放的 packet 数，容量覆盖该上限，并为刷新包、结束包留出余量
+    static constexpr size_t kMarkerPacketReserve = 16;
+    static constexpr size_t kPacketQueueCapacity = IDeMuxer::kMaxPendingPackets + kMarkerPacketReserve;
+    SPSCQueue<std::shared_ptr<IAVPacket>> m_packetQueue{kPacketQueueCapacity};
+    std::atomic<int> m_pendingFlushCount{0};
+    std::atomic<bool> m_clearRequested{false};
+    // 跳转目标，早于该值的帧被丢弃，只在解码线程访问
+    int64_t m_discardBeforePts{AV_NOPTS_VALUE};
 
     // 解码
     std::mutex m_codecContextMutex;
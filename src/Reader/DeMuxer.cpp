@@ -1,5 +1,9 @@
 #include "DeMuxer.h"
 
+#ifndef CACHE_DIR
+#define CACHE_DIR "cache"
+#endif
+
 namespace av {
 
 IDeMuxer* IDeMuxer::Create() {
@@ -7,12 +11,12 @@ IDeMuxer* IDeMuxer::Create() {
 }
 
 void DeMuxer::ReleaseVideoPipelineResource() {
-    m_audioStream.pipelineResourceCount++;
+    m_videoStream.pipelineResourceCount++;
     m_notifier.Notify();
 }
 
 void DeMuxer::ReleaseAudioPipelineResource() {
-    m_videoStream.pipelineResourceCount++;
+    m_audioStream.pipelineResourceCount++;
     m_notifier.Notify();
 }
 
@@ -21,7 +25,7 @@ void DeMuxer::SetListener(IDeMuxer::Listener* listener) {
     m_listener = listener;
 }
 
-DeMuxer::DeMuxer() {
+DeMuxer::DeMuxer() : m_seekIndexCache(std::string(CACHE_DIR) + "/seek_index") {
     m_videoStream.pipelineReleaseCallback = std::make_shared<std::function<void()>>([&]() {
         ReleaseVideoPipelineResource();
     });
@@ -36,6 +40,7 @@ DeMuxer::~DeMuxer() {
     if (m_thread.joinable()) {
         m_thread.join();
     }
+    StopIndexThread();
     std::lock_guard<std::mutex> lock(m_formatMutex);
     if (m_formatCtx) {
         avformat_close_input(&m_formatCtx);
@@ -43,14 +48,23 @@ DeMuxer::~DeMuxer() {
 }
 
 bool DeMuxer::Open(const std::string& url) {
+    StopIndexThread();
+    m_keyframeIndex.Clear();
+
     std::lock_guard<std::mutex> lock(m_formatMutex);
     // 打开文件
     if (avformat_open_input(&m_formatCtx, url.c_str(), nullptr, nullptr) != 0) {
         return false;
     }
-    // 读取流
-    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
-        return false;
+    // 命中磁盘缓存时用缓存的流参数代替 avformat_find_stream_info 探测
+    SeekIndexCacheEntry cacheEntry;
+    bool cached = m_seekIndexCache.Load(url, cacheEntry) && SeekIndexCache::ApplyStreamInfo(cacheEntry, m_formatCtx);
+    if (!cached) {
+        // 读取流
+        if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
+            return false;
+        }
+        SeekIndexCache::CaptureStreamInfo(m_formatCtx, cacheEntry);
     }
     for (unsigned int i = 0; i < m_formatCtx->nb_streams; i++) {
         if (m_formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
@@ -63,9 +77,75 @@ bool DeMuxer::Open(const std::string& url) {
             m_listener->OnNotifyVideoStream(m_formatCtx->streams[i]);
         }
     }
+
+    int videoIndex = m_videoStream.streamIndex;
+    if (cached && (videoIndex < 0 || cacheEntry.keyframes.count(videoIndex))) {
+        m_keyframeIndex.Restore(std::move(cacheEntry.keyframes));
+        return true;
+    }
+    // 先缓存流参数；关键帧索引推迟到第一次跳转时再建立，不跳转的播放不额外读取整个文件
+    if (!cached) m_seekIndexCache.Save(url, cacheEntry);
+    if (videoIndex >= 0) {
+        std::lock_guard<std::mutex> indexLock(m_indexMutex);
+        m_pendingIndex = PendingIndex{true, url, videoIndex, std::move(cacheEntry)};
+    }
     return true;
 }
 
+void DeMuxer::StartIndexThread() {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    if (!m_pendingIndex.pending) return;
+    m_pendingIndex.pending = false;
+    // 索引在后台建立，建立完成前的跳转回退到 av_seek_frame，建立完成后写入缓存
+    m_indexAbort = false;
+    m_indexThread = std::thread(&DeMuxer::BuildKeyframeIndex, this, std::move(m_pendingIndex.url),
+                                m_pendingIndex.videoStreamIndex, std::move(m_pendingIndex.cacheEntry));
+}
+
+void DeMuxer::BuildKeyframeIndex(std::string url, int videoStreamIndex, SeekIndexCacheEntry cacheEntry) {
+    // 使用独立的 AVFormatContext，不影响播放线程的读取位置
+    AVFormatContext* formatCtx = nullptr;
+    if (avformat_open_input(&formatCtx, url.c_str(), nullptr, nullptr) != 0) {
+        std::cerr << "Keyframe index: failed to open " << url << std::endl;
+        return;
+    }
+    // 只关心视频流，其它流交给解复用器直接跳过
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        if (static_cast<int>(i) != videoStreamIndex) {
+            formatCtx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    AVPacket packet;
+    int ret = 0;
+    while (!m_indexAbort && (ret = av_read_frame(formatCtx, &packet)) >= 0) {
+        if (packet.stream_index == videoStreamIndex && (packet.flags & AV_PKT_FLAG_KEY)) {
+            int64_t pts = packet.pts != AV_NOPTS_VALUE ? packet.pts : packet.dts;
+            if (pts != AV_NOPTS_VALUE) {
+                m_keyframeIndex.AddEntry(videoStreamIndex, KeyframeEntry{pts, packet.pos});
+            }
+        }
+        av_packet_unref(&packet);
+    }
+    avformat_close_input(&formatCtx);
+    if (ret == AVERROR_EOF) {
+        m_keyframeIndex.MarkComplete();
+        cacheEntry.keyframes = m_keyframeIndex.GetEntries();
+        if (!m_seekIndexCache.Save(url, cacheEntry)) {
+            std::cerr << "Failed to save seek index cache for " << url << std::endl;
+        }
+    }
+}
+
+void DeMuxer::StopIndexThread() {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    m_pendingIndex = PendingIndex{};
+    m_indexAbort = true;
+    if (m_indexThread.joinable()) {
+        m_indexThread.join();
+    }
+}
+
 bool DeMuxer::ReadAndSendPacket() {
     std::lock_guard<std::mutex> lock(m_formatMutex);
     if (m_formatCtx == nullptr) {
@@ -95,6 +175,7 @@ bool DeMuxer::ReadAndSendPacket() {
         }
         av_packet_unref(&packet);
     } else if (ret == AVERROR_EOF) {
+        NotifyEndOfStream();
         m_paused = true;
     } else {
         return false;
@@ -116,46 +197,102 @@ void DeMuxer::ProcessSeek() {
     if (m_formatCtx == nullptr) {
         return;
     }
+    SeekMode mode = m_seekMode;
     int64_t timestamp = static_cast<int64_t>(m_seekProgress * m_formatCtx->duration);
-    // 跳转到指定的时间戳 timestamp
-    if (av_seek_frame(m_formatCtx, -1, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+    if (m_formatCtx->start_time != AV_NOPTS_VALUE) {
+        timestamp += m_formatCtx->start_time;
+    }
+
+    // 优先使用关键帧索引：快速模式取最近的关键帧，精确模式取目标之前的关键帧
+    KeyframeEntry keyframe;
+    bool indexed = false;
+    int videoIndex = m_videoStream.streamIndex;
+    if (videoIndex >= 0) {
+        AVRational timeBase = m_formatCtx->streams[videoIndex]->time_base;
+        int64_t streamTarget = av_rescale_q(timestamp, AVRational{1, AV_TIME_BASE}, timeBase);
+        indexed = mode == SeekMode::kFast ? m_keyframeIndex.FindNearest(videoIndex, streamTarget, keyframe)
+                                          : m_keyframeIndex.FindBefore(videoIndex, streamTarget, keyframe);
+        indexed = indexed && SeekToKeyframe(videoIndex, keyframe);
+        if (indexed && mode == SeekMode::kFast) {
+            timestamp = av_rescale_q(keyframe.pts, timeBase, AVRational{1, AV_TIME_BASE});
+        }
+    }
+    if (!indexed && av_seek_frame(m_formatCtx, -1, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
         std::cerr << "Seek failed" << std::endl;
     }
 
-    // 跳转到指定位置后进行解复用，然后通知解码器处理 packet
-    {
-        std::lock_guard<std::recursive_mutex> listenerLock(m_listenerMutex);
-        auto audioPacket = std::make_shared<IAVPacket>(nullptr);
-        audioPacket->flags |= static_cast<int>(AVFrameFlag::kFlush);
-        m_listener->OnNotifyAudioPacket(audioPacket);
+    // 精确模式丢弃目标之前的帧；快速模式以关键帧为起点，没有索引时不知道关键帧位置，不做丢弃
+    bool discard = mode == SeekMode::kExact || indexed;
+    NotifyFlushPacket(discard ? timestamp : AV_NOPTS_VALUE);
 
-        auto videoPacket = std::make_shared<IAVPacket>(nullptr);
-        videoPacket->flags |= static_cast<int>(AVFrameFlag::kFlush);
-        m_listener->OnNotifyVideoPacket(videoPacket);
-    }
     m_seekProgress = -1.0f;
     m_seek = false;
 }
 
-void DeMuxer::SeekTo(float progress) {
+bool DeMuxer::SeekToKeyframe(int streamIndex, const KeyframeEntry& keyframe) {
+    // 时间戳不连续的格式（如 MPEG-TS）按时间戳定位不准确，此时按字节偏移定位
+    int formatFlags = m_formatCtx->iformat->flags;
+    bool byteSeek = keyframe.pos >= 0 && (formatFlags & AVFMT_TS_DISCONT) && !(formatFlags & AVFMT_NO_BYTE_SEEK);
+    if (byteSeek && av_seek_frame(m_formatCtx, streamIndex, keyframe.pos, AVSEEK_FLAG_BYTE) >= 0) {
+        return true;
+    }
+    return avformat_seek_file(m_formatCtx, streamIndex, INT64_MIN, keyframe.pts, keyframe.pts, 0) >= 0;
+}
+
+void DeMuxer::NotifyFlushPacket(int64_t discardBeforeTimestamp) {
+    auto createFlushPacket = [&](int streamIndex) {
+        auto packet = std::make_shared<IAVPacket>(nullptr);
+        packet->flags |= static_cast<int>(AVFrameFlag::kFlush);
+        if (streamIndex >= 0 && discardBeforeTimestamp != AV_NOPTS_VALUE) {
+            AVRational timeBase = m_formatCtx->streams[streamIndex]->time_base;
+            packet->discardBeforePts = av_rescale_q(discardBeforeTimestamp, AVRational{1, AV_TIME_BASE}, timeBase);
+        }
+        return packet;
+    };
+
+    // 跳转到指定位置后进行解复用，然后通知解码器处理 packet
+    std::lock_guard<std::recursive_mutex> listenerLock(m_listenerMutex);
+    m_listener->OnNotifyAudioPacket(createFlushPacket(m_audioStream.streamIndex));
+    m_listener->OnNotifyVideoPacket(createFlushPacket(m_videoStream.streamIndex));
+}
+
+void DeMuxer::NotifyEndOfStream() {
+    // 结束包让解码器输出缓存中剩余的帧，再向上层通知结束
+    std::lock_guard<std::recursive_mutex> listenerLock(m_listenerMutex);
+    if (!m_listener) return;
+    auto audioPacket = std::make_shared<IAVPacket>(nullptr);
+    audioPacket->flags |= static_cast<int>(AVFrameFlag::kEOS);
+    m_listener->OnNotifyAudioPacket(audioPacket);
+
+    auto videoPacket = std::make_shared<IAVPacket>(nullptr);
+    videoPacket->flags |= static_cast<int>(AVFrameFlag::kEOS);
+    m_listener->OnNotifyVideoPacket(videoPacket);
+}
+
+void DeMuxer::SeekTo(float progress, SeekMode mode) {
+    // 第一次跳转时开始建立关键帧索引（已建立或已从缓存恢复时不做任何事）
+    StartIndexThread();
     m_seekProgress = progress;
+    m_seekMode = mode;
     m_seek = true;
     m_notifier.Notify();
 }
 
 void DeMuxer::ThreadLoop() {
-    while(true) {
-        // 限时阻塞，主要是避免解复用太快
-        m_notifier.Wait(100);
+    bool failed = false;
+    while (!failed) {
+        // 无超时等待：解码器归还 packet、跳转、启动/停止都会唤醒线程
+        m_notifier.Wait();
         if (m_abort) {
-            break;;
+            break;
         }
         if (m_seek) {
             ProcessSeek();
         }
-        // 当线程未暂停且流缓冲充足则进行解复用 (count 用于控制解复用速度，避免后面解码难以跟上)
-        if (!m_paused && (m_audioStream.pipelineResourceCount > 0 || m_videoStream.pipelineResourceCount > 0)) {
+        // 当线程未暂停且流缓冲充足则连续解复用，直到资源耗尽 (count 用于控制解复用速度，避免后面解码难以跟上)
+        while (!m_abort && !m_seek && !m_paused && HasPipelineResource()) {
             if (!ReadAndSendPacket()) {
+                failed = true;
                 break;
             }
         }
@@ -163,6 +300,14 @@ void DeMuxer::ThreadLoop() {
 }
 
 
+bool DeMuxer::HasPipelineResource() const {
+    // 任意一路流需要数据即继续读取，避免一路阻塞导致另一路（如音频时钟）饿死
+    bool audioNeedsData = m_audioStream.streamIndex >= 0 && m_audioStream.pipelineResourceCount > 0;
+    bool videoNeedsData = m_videoStream.streamIndex >= 0 && m_videoStream.pipelineResourceCount > 0;
+    // 积压到上限时等待该路解码器消费，保证解码器的 packet 队列不会溢出
+    return (audioNeedsData || videoNeedsData) && !m_audioStream.IsPendingFull() && !m_videoStream.IsPendingFull();
+}
+
 void DeMuxer::Start() {
     m_paused = false;
     m_notifier.Notify();
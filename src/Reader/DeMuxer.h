@@ -2,12 +2,15 @@
 
 #include "Interface/IDeMuxer.h"
 #include "Core/SyncNotifier.h"
+#include "KeyframeIndex.h"
+#include "SeekIndexCache.h"
 #include <mutex>
 #include <atomic>
 #include <memory>
 #include <thread>
 #include <functional>
 #include <iostream>
+#include <string>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -33,7 +36,7 @@ public:
     bool Open(const std::string& url) override;
     
     // 跳转到指定进度
-    void SeekTo(float progress) override;
+    void SeekTo(float progress, SeekMode mode) override;
 
     // 获取总时长
     float GetDuration() override;
@@ -42,8 +45,13 @@ private:
     struct StreamInfo {
         // 当前流下标
         int streamIndex{-1};
-        // 
-        std::atomic<int> pipelineResourceCount{3};
+        static constexpr int kPipelineResourceCount = 3;
+        // 为正表示下游需要数据；一路积压时另一路仍可读取，计数可以为负
+        std::atomic<int> pipelineResourceCount{kPipelineResourceCount};
+        // 已送出、尚未释放的 packet 数达到上限
+        bool IsPendingFull() const {
+            return streamIndex >= 0 && kPipelineResourceCount - pipelineResourceCount >= kMaxPendingPackets;
+        }
         std::shared_ptr<std::function<void()>> pipelineReleaseCallback;
     };
     void ReleaseVideoPipelineResource();
@@ -58,6 +66,20 @@ private:
     bool ReadAndSendPacket();
     // 跳转到指定时间戳然后进行解复用
     void ProcessSeek();
+    // 按索引中的关键帧定位
+    bool SeekToKeyframe(int streamIndex, const KeyframeEntry& keyframe);
+    // 向解码器发送刷新包，timestamp 为 AV_TIME_BASE 时间基下需丢弃之前数据的时间点
+    void NotifyFlushPacket(int64_t discardBeforeTimestamp);
+    // 读到文件末尾时向解码器发送结束包
+    void NotifyEndOfStream();
+
+    // 在后台线程中用独立的 AVFormatContext 扫描视频流关键帧，完成后连同流参数写入磁盘缓存
+    void BuildKeyframeIndex(std::string url, int videoStreamIndex, SeekIndexCacheEntry cacheEntry);
+    // 有待建立的索引时启动扫描线程，第一次跳转时调用
+    void StartIndexThread();
+    void StopIndexThread();
+    // 下游是否还有空闲资源接收 packet，且没有任何一路积压到上限
+    bool HasPipelineResource() const;
 
 private:
     IDeMuxer::Listener* m_listener{nullptr};
@@ -78,6 +100,22 @@ private:
     // 跳转
     std::atomic<bool> m_seek{false};
     float m_seekProgress{-1.0f};
+    std::atomic<SeekMode> m_seekMode{SeekMode::kExact};
+
+    // 关键帧索引及其磁盘缓存
+    KeyframeIndex m_keyframeIndex;
+    SeekIndexCache m_seekIndexCache;
+    // 打开文件时只记录建立索引所需的信息，第一次跳转时才开始扫描
+    struct PendingIndex {
+        bool pending{false};
+        std::string url;
+        int videoStreamIndex{-1};
+        SeekIndexCacheEntry cacheEntry;
+    };
+    std::mutex m_indexMutex;    // 管理 m_pendingIndex 和 m_indexThread
+    PendingIndex m_pendingIndex;
+    std::thread m_indexThread;
+    std::atomic<bool> m_indexAbort{false};
 };
 
 }
\ No newline at end of file
@@ -25,9 +25,9 @@ FileReader::~FileReader() {
 }
 
 
-void FileReader::SeekTo(float progress) {
+void FileReader::SeekTo(float progress, SeekMode mode) {
     if (m_deMuxer) {
-        m_deMuxer->SeekTo(progress);
+        m_deMuxer->SeekTo(progress, mode);
     }
 }
 
@@ -80,13 +80,57 @@ int FileReader::GetVideoHeight() {
     return m_videoDecoder ? m_videoDecoder->GetVideoHeight() : 0;
 }
 
+void FileReader::SetVideoYUVOutputEnabled(bool enabled) {
+    if (m_videoDecoder) {
+        m_videoDecoder->SetYUVOutputEnabled(enabled);
+    }
+}
+
+FrameBufferPoolStats FileReader::GetFrameBufferPoolStats() {
+    return m_videoDecoder ? m_videoDecoder->GetFrameBufferPoolStats() : FrameBufferPoolStats{};
+}
+
+void FileReader::SetVideoDecodeThreading(const DecodeThreadingParameters& parameters) {
+    if (m_videoDecoder) {
+        m_videoDecoder->SetThreadingParameters(parameters);
+    }
+}
+
+int FileReader::GetVideoDecodeThreadCount() {
+    return m_videoDecoder ? m_videoDecoder->GetEffectiveThreadCount() : 0;
+}
+
+void FileReader::SetVideoSkipNonReferenceFrames(bool enabled) {
+    if (m_videoDecoder) {
+        m_videoDecoder->SetSkipNonReferenceFrames(enabled);
+    }
+}
+
+uint64_t FileReader::GetVideoSkippedFrameCount() {
+    return m_videoDecoder ? m_videoDecoder->GetSkippedFrameCount() : 0;
+}
+
+AVStream* FileReader::GetAudioStream() {
+    return m_audioStream;
+}
+
+AVStream* FileReader::GetVideoStream() {
+    return m_videoStream;
+}
+
+void FileReader::SetPacketOutputEnabled(bool enabled) {
+    m_packetOutputEnabled = enabled;
+}
+
 void FileReader::OnNotifyAudioStream(struct AVStream* stream) {
+    m_audioStream = stream;
     if (m_audioDecoder) {
         m_audioDecoder->SetStream(stream);
     }
 }
 
 void FileReader::OnNotifyVideoStream(struct AVStream* stream) {
+    m_videoStream = stream;
     if (m_videoDecoder) {
         m_videoDecoder->SetStream(stream);
     }
@@ -101,11 +145,28 @@ bool FileReader::Open(const std::string& filePath) {
     if (!m_deMuxer) {
         return false;
     }
+    m_audioStream = nullptr;
+    m_videoStream = nullptr;
     return m_deMuxer->Open(filePath);
 }
 
 
+std::shared_ptr<IAVPacket> FileReader::ClonePacket(const std::shared_ptr<IAVPacket>& packet, AVStream* stream) {
+    // av_packet_clone 只增加压缩数据的引用计数；副本不参与解码资源计数
+    auto clonedPacket = std::make_shared<IAVPacket>(packet->avPacket ? av_packet_clone(packet->avPacket) : nullptr);
+    clonedPacket->flags = packet->flags;
+    if (stream) {
+        clonedPacket->timeBase = stream->time_base;
+    }
+    return clonedPacket;
+}
+
 void FileReader::OnNotifyAudioPacket(std::shared_ptr<IAVPacket> packet) {
+    if (m_packetOutputEnabled) {
+        auto clonedPacket = ClonePacket(packet, m_audioStream);
+        std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+        if (m_listener) m_listener->OnFileReaderNotifyAudioPacket(clonedPacket);
+    }
     if (m_audioDecoder) {
         m_audioDecoder->Decode(packet);
     }
@@ -113,6 +174,11 @@ void FileReader::OnNotifyAudioPacket(std::shared_ptr<IAVPacket> packet) {
 
 
 void FileReader::OnNotifyVideoPacket(std::shared_ptr<IAVPacket> packet) {
+    if (m_packetOutputEnabled) {
+        auto clonedPacket = ClonePacket(packet, m_videoStream);
+        std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+        if (m_listener) m_listener->OnFileReaderNotifyVideoPacket(clonedPacket);
+    }
     if (m_videoDecoder) {
         m_videoDecoder->Decode(packet);
     }
@@ -120,14 +186,20 @@ void FileReader::OnNotifyVideoPacket(std::shared_ptr<IAVPacket> packet) {
 
 void FileReader::OnNotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
     std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
-    if (m_listener) {
+    if (!m_listener) return;
+    if (audioSamples->flags & static_cast<int>(AVFrameFlag::kEOS)) {
+        m_listener->OnFileReaderNotifyAudioFinished();
+    } else {
         m_listener->OnFileReaderNotifyAudioSamples(audioSamples);
     }
 }
 
 void FileReader::OnNotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
     std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
-    if (m_listener) {
+    if (!m_listener) return;
+    if (videoFrame->flags & static_cast<int>(AVFrameFlag::kEOS)) {
+        m_listener->OnFileReaderNotifyVideoFinished();
+    } else {
         m_listener->OnFileReaderNotifyVideoFrame(videoFrame);
     }
 }
@@ -4,6 +4,7 @@
 #include "AudioDecoder.h"
 #include "VideoDecoder.h"
 #include "Interface/IFileReader.h"
+#include <atomic>
 #include <fstream>
 
 
@@ -19,7 +20,7 @@ public:
     void SetListener(IFileReader::Listener* listener) override;
     bool Open(const std::string& filePath) override;
 
-    void SeekTo(float progress) override;
+    void SeekTo(float progress, SeekMode mode) override;
 
     // 并发相关
     void Start() override;
@@ -31,6 +32,18 @@ public:
     int GetVideoWidth() override;
     int GetVideoHeight() override;
 
+    AVStream* GetAudioStream() override;
+    AVStream* GetVideoStream() override;
+    void SetPacketOutputEnabled(bool enabled) override;
+
+    void SetVideoYUVOutputEnabled(bool enabled) override;
+    FrameBufferPoolStats GetFrameBufferPoolStats() override;
+
+    void SetVideoDecodeThreading(const DecodeThreadingParameters& parameters) override;
+    int GetVideoDecodeThreadCount() override;
+    void SetVideoSkipNonReferenceFrames(bool enabled) override;
+    uint64_t GetVideoSkippedFrameCount() override;
+
 private:
     // IDeMuxer::Listener
     // 当解复用结束分别处理音频和视频流
@@ -42,6 +55,9 @@ private:
     void OnNotifyVideoPacket(std::shared_ptr<IAVPacket> packet) override;
 
 
+    // 复制数据包交给上层，解码器仍使用原始包
+    std::shared_ptr<IAVPacket> ClonePacket(const std::shared_ptr<IAVPacket>& packet, AVStream* stream);
+
     // IAudioDecoder::Listener
     void OnNotifyAudioSamples(std::shared_ptr<IAudioSamples>) override;
 
@@ -59,6 +75,11 @@ private:
     // 解码器
     std::shared_ptr<IAudioDecoder> m_audioDecoder;
     std::shared_ptr<IVideoDecoder> m_videoDecoder;
+
+    // 由解复用线程在 Open 时设置
+    std::atomic<AVStream*> m_audioStream{nullptr};
+    std::atomic<AVStream*> m_videoStream{nullptr};
+    std::atomic<bool> m_packetOutputEnabled{false};
 };
 
 
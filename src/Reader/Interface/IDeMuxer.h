@@ -2,6 +2,7 @@
 #include <string>
 
 #include "Define/IAVPacket.h"
+#include "Define/SeekMode.h"
 
 // FFmpeg (libavformat, libavcodec, etc.) 是一个 C 语言库。
 // 它的所有结构体（如 AVStream, AVCodecContext, AVFormatContext）和函数
@@ -26,12 +27,16 @@ struct IDeMuxer {
     };
 
 
+    // 每路流已送出、尚未被下游释放的 packet 数上限。下一个 packet 属于哪一路事先无法得知，
+    // 任意一路达到上限即暂停读取；解码器的 packet 队列容量覆盖该上限，入队不会失败
+    static constexpr int kMaxPendingPackets = 240;
+
     virtual ~IDeMuxer() = default;
     static IDeMuxer* Create();
 
     virtual void SetListener(Listener* listener) = 0;
     virtual bool Open(const std::string& url) = 0;
-    virtual void SeekTo(float progress)= 0;
+    virtual void SeekTo(float progress, SeekMode mode = SeekMode::kExact) = 0;
     virtual float GetDuration() = 0;
 
     virtual void Start() = 0;
@@ -1,6 +1,8 @@
 #pragma once
 #include "Define/IAVPacket.h"
 #include "Define/IVideoFrame.h"
+#include "Core/FrameBufferPool.h"
+#include "Define/DecodeThreadingParameters.h"
 
 struct AVStream;
 namespace av {
@@ -25,6 +27,22 @@ struct IVideoDecoder {
 
     virtual int GetVideoWidth() = 0;
     virtual int GetVideoHeight() = 0;
+
+    // 开启后 YUV420P/NV12 帧不再转换为 RGBA，直接以 avFrame 形式输出
+    virtual void SetYUVOutputEnabled(bool enabled) = 0;
+
+    // RGBA 帧缓冲池的统计信息
+    virtual FrameBufferPoolStats GetFrameBufferPoolStats() = 0;
+
+    // 解码线程配置，需在 SetStream 之前设置，下次打开解码器时生效
+    virtual void SetThreadingParameters(const DecodeThreadingParameters& parameters) = 0;
+    // 解码器实际使用的线程数
+    virtual int GetEffectiveThreadCount() = 0;
+
+    // 播放持续落后时跳过非参考帧（skip_frame = AVDISCARD_NONREF），减轻解码及后续处理负载
+    virtual void SetSkipNonReferenceFrames(bool enabled) = 0;
+    // 跳过非参考帧期间少输出的帧数（按送入的 packet 与输出的帧之差估计）
+    virtual uint64_t GetSkippedFrameCount() = 0;
 };
 
 }
\ No newline at end of file
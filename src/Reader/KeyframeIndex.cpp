@@ -0,0 +1,79 @@
+#include "KeyframeIndex.h"
+
+#include <algorithm>
+
+namespace av {
+
+void KeyframeIndex::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_complete = false;
+}
+
+void KeyframeIndex::AddEntry(int streamIndex, const KeyframeEntry& entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entries = m_entries[streamIndex];
+    // 个别封装格式的 pts 存在回退，只保留递增部分，保证二分查找有效
+    if (!entries.empty() && entry.pts <= entries.back().pts) return;
+    entries.push_back(entry);
+}
+
+void KeyframeIndex::MarkComplete() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_complete = true;
+}
+
+bool KeyframeIndex::IsComplete() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_complete;
+}
+
+std::unordered_map<int, std::vector<KeyframeEntry>> KeyframeIndex::GetEntries() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries;
+}
+
+void KeyframeIndex::Restore(std::unordered_map<int, std::vector<KeyframeEntry>> entries) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries = std::move(entries);
+    m_complete = true;
+}
+
+const std::vector<KeyframeEntry>* KeyframeIndex::GetCoveringEntries(int streamIndex, int64_t targetPts) {
+    auto it = m_entries.find(streamIndex);
+    if (it == m_entries.end() || it->second.empty()) return nullptr;
+    // 扫描未完成时，目标之后的关键帧可能还没被发现
+    if (!m_complete && targetPts >= it->second.back().pts) return nullptr;
+    return &it->second;
+}
+
+bool KeyframeIndex::FindBefore(int streamIndex, int64_t targetPts, KeyframeEntry& entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entries = GetCoveringEntries(streamIndex, targetPts);
+    if (!entries) return false;
+
+    auto it = std::upper_bound(entries->begin(), entries->end(), targetPts,
+                               [](int64_t pts, const KeyframeEntry& e) { return pts < e.pts; });
+    entry = it == entries->begin() ? entries->front() : *(it - 1);
+    return true;
+}
+
+bool KeyframeIndex::FindNearest(int streamIndex, int64_t targetPts, KeyframeEntry& entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entries = GetCoveringEntries(streamIndex, targetPts);
+    if (!entries) return false;
+
+    auto it = std::lower_bound(entries->begin(), entries->end(), targetPts,
+                               [](const KeyframeEntry& e, int64_t pts) { return e.pts < pts; });
+    if (it == entries->end()) {
+        entry = entries->back();
+    } else if (it == entries->begin()) {
+        entry = *it;
+    } else {
+        auto prev = it - 1;
+        entry = (targetPts - prev->pts <= it->pts - targetPts) ? *prev : *it;
+    }
+    return true;
+}
+
+}  // namespace av
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace av {
+
+// 关键帧位置
+struct KeyframeEntry {
+    int64_t pts{0};     // 流时间基下的时间戳
+    int64_t pos{-1};    // 所在 packet 的文件字节偏移，未知为 -1
+};
+
+// 按流记录的关键帧索引，后台线程边扫描边追加，跳转线程同时查询
+class KeyframeIndex {
+public:
+    void Clear();
+
+    // 同一路流的 pts 需按递增顺序追加
+    void AddEntry(int streamIndex, const KeyframeEntry& entry);
+    // 扫描完整个文件后调用
+    void MarkComplete();
+    bool IsComplete();
+
+    // 导出/导入完整索引，用于磁盘缓存，导入后视为扫描完成
+    std::unordered_map<int, std::vector<KeyframeEntry>> GetEntries();
+    void Restore(std::unordered_map<int, std::vector<KeyframeEntry>> entries);
+
+    // 查找 pts 不大于 targetPts 的最后一个关键帧，索引尚未覆盖到目标时返回 false
+    bool FindBefore(int streamIndex, int64_t targetPts, KeyframeEntry& entry);
+    // 查找离 targetPts 最近的关键帧，索引尚未覆盖到目标时返回 false
+    bool FindNearest(int streamIndex, int64_t targetPts, KeyframeEntry& entry);
+
+private:
+    // 调用前需持有 m_mutex
+    const std::vector<KeyframeEntry>* GetCoveringEntries(int streamIndex, int64_t targetPts);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<int, std::vector<KeyframeEntry>> m_entries;
+    bool m_complete{false};
+};
+
+}  // namespace av
@@ -0,0 +1,259 @@
+#include "SeekIndexCache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace av {
+
+namespace {
+
+constexpr const char* kCacheMagic = "avplayer-seek-index";
+constexpr int kCacheVersion = 1;
+
+std::string ToHex(const std::vector<uint8_t>& data) {
+    if (data.empty()) return "-";
+    static const char* kDigits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(data.size() * 2);
+    for (uint8_t byte : data) {
+        hex.push_back(kDigits[byte >> 4]);
+        hex.push_back(kDigits[byte & 0x0f]);
+    }
+    return hex;
+}
+
+bool FromHex(const std::string& hex, std::vector<uint8_t>& data) {
+    data.clear();
+    if (hex == "-") return true;
+    if (hex.size() % 2 != 0) return false;
+    auto digit = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    };
+    data.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int high = digit(hex[i]);
+        int low = digit(hex[i + 1]);
+        if (high < 0 || low < 0) return false;
+        data.push_back(static_cast<uint8_t>(high << 4 | low));
+    }
+    return true;
+}
+
+}  // namespace
+
+SeekIndexCache::SeekIndexCache(std::string cacheDir) : m_cacheDir(std::move(cacheDir)) {}
+
+bool SeekIndexCache::GetFileStamp(const std::string& url, int64_t& size, int64_t& modifiedTime) {
+    std::error_code ec;
+    auto path = std::filesystem::u8path(url);
+    if (!std::filesystem::is_regular_file(path, ec)) return false;
+    size = static_cast<int64_t>(std::filesystem::file_size(path, ec));
+    if (ec) return false;
+    modifiedTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+std::string SeekIndexCache::GetCachePath(const std::string& url) const {
+    std::ostringstream name;
+    name << std::hex << std::hash<std::string>{}(url) << ".index";
+    return m_cacheDir + "/" + name.str();
+}
+
+bool SeekIndexCache::Load(const std::string& url, SeekIndexCacheEntry& entry) {
+    int64_t size = 0;
+    int64_t modifiedTime = 0;
+    if (!GetFileStamp(url, size, modifiedTime)) return false;
+
+    std::ifstream file(std::filesystem::u8path(GetCachePath(url)));
+    if (!file) return false;
+
+    // 文件头：标识、版本、原路径、大小、修改时间，任一不一致即视为失效
+    std::string magic;
+    int version = 0;
+    std::string cachedUrl;
+    int64_t cachedSize = -1;
+    int64_t cachedModifiedTime = -1;
+    file >> magic >> version;
+    file.ignore();
+    std::getline(file, cachedUrl);
+    file >> cachedSize >> cachedModifiedTime;
+    if (!file || magic != kCacheMagic || version != kCacheVersion || cachedUrl != url || cachedSize != size ||
+        cachedModifiedTime != modifiedTime) {
+        return false;
+    }
+
+    SeekIndexCacheEntry result;
+    size_t streamCount = 0;
+    file >> result.startTime >> result.duration >> streamCount;
+    for (size_t i = 0; file && i < streamCount; ++i) {
+        CachedStreamInfo info;
+        std::string extradata;
+        file >> info.codecType >> info.codecId >> info.format >> info.width >> info.height >> info.sampleRate >>
+            info.channels >> info.channelLayout >> info.bitRate >> info.profile >> info.level >> info.timeBaseNum >>
+            info.timeBaseDen >> info.sampleAspectNum >> info.sampleAspectDen >> info.frameRateNum >>
+            info.frameRateDen >> info.startTime >> info.duration >> extradata;
+        if (!file || !FromHex(extradata, info.extradata)) return false;
+        result.streams.push_back(std::move(info));
+    }
+
+    size_t indexCount = 0;
+    file >> indexCount;
+    for (size_t i = 0; file && i < indexCount; ++i) {
+        int streamIndex = -1;
+        size_t entryCount = 0;
+        file >> streamIndex >> entryCount;
+        auto& keyframes = result.keyframes[streamIndex];
+        keyframes.reserve(entryCount);
+        for (size_t j = 0; file && j < entryCount; ++j) {
+            KeyframeEntry keyframe;
+            file >> keyframe.pts >> keyframe.pos;
+            keyframes.push_back(keyframe);
+        }
+    }
+    if (!file) {
+        std::cerr << "Seek index cache is corrupted: " << GetCachePath(url) << std::endl;
+        return false;
+    }
+
+    entry = std::move(result);
+    return true;
+}
+
+bool SeekIndexCache::Save(const std::string& url, const SeekIndexCacheEntry& entry) {
+    int64_t size = 0;
+    int64_t modifiedTime = 0;
+    if (!GetFileStamp(url, size, modifiedTime)) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::u8path(m_cacheDir), ec);
+
+    // 先写临时文件再替换，避免中途退出留下不完整的缓存
+    auto cachePath = std::filesystem::u8path(GetCachePath(url));
+    auto tempPath = cachePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file) return false;
+
+        file << kCacheMagic << ' ' << kCacheVersion << '\n' << url << '\n' << size << ' ' << modifiedTime << '\n';
+        file << entry.startTime << ' ' << entry.duration << ' ' << entry.streams.size() << '\n';
+        for (const auto& info : entry.streams) {
+            file << info.codecType << ' ' << info.codecId << ' ' << info.format << ' ' << info.width << ' '
+                 << info.height << ' ' << info.sampleRate << ' ' << info.channels << ' ' << info.channelLayout << ' '
+                 << info.bitRate << ' ' << info.profile << ' ' << info.level << ' ' << info.timeBaseNum << ' '
+                 << info.timeBaseDen << ' ' << info.sampleAspectNum << ' ' << info.sampleAspectDen << ' '
+                 << info.frameRateNum << ' ' << info.frameRateDen << ' ' << info.startTime << ' ' << info.duration
+                 << ' ' << ToHex(info.extradata) << '\n';
+        }
+        file << entry.keyframes.size() << '\n';
+        for (const auto& [streamIndex, keyframes] : entry.keyframes) {
+            file << streamIndex << ' ' << keyframes.size() << '\n';
+            for (const auto& keyframe : keyframes) {
+                file << keyframe.pts << ' ' << keyframe.pos << '\n';
+            }
+        }
+        if (!file) return false;
+    }
+
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+void SeekIndexCache::CaptureStreamInfo(AVFormatContext* formatCtx, SeekIndexCacheEntry& entry) {
+    entry.startTime = formatCtx->start_time;
+    entry.duration = formatCtx->duration;
+    entry.streams.clear();
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        AVStream* stream = formatCtx->streams[i];
+        AVCodecParameters* par = stream->codecpar;
+
+        CachedStreamInfo info;
+        info.codecType = par->codec_type;
+        info.codecId = par->codec_id;
+        info.format = par->format;
+        info.width = par->width;
+        info.height = par->height;
+        info.sampleRate = par->sample_rate;
+        info.channels = par->channels;
+        info.channelLayout = par->channel_layout;
+        info.bitRate = par->bit_rate;
+        info.profile = par->profile;
+        info.level = par->level;
+        info.timeBaseNum = stream->time_base.num;
+        info.timeBaseDen = stream->time_base.den;
+        info.sampleAspectNum = par->sample_aspect_ratio.num;
+        info.sampleAspectDen = par->sample_aspect_ratio.den;
+        info.frameRateNum = stream->avg_frame_rate.num;
+        info.frameRateDen = stream->avg_frame_rate.den;
+        info.startTime = stream->start_time;
+        info.duration = stream->duration;
+        if (par->extradata && par->extradata_size > 0) {
+            info.extradata.assign(par->extradata, par->extradata + par->extradata_size);
+        }
+        entry.streams.push_back(std::move(info));
+    }
+}
+
+bool SeekIndexCache::ApplyStreamInfo(const SeekIndexCacheEntry& entry, AVFormatContext* formatCtx) {
+    // 只有封装头已经给出相同的流布局时才信任缓存，否则仍需完整探测
+    if (formatCtx->nb_streams != entry.streams.size()) return false;
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        AVCodecParameters* par = formatCtx->streams[i]->codecpar;
+        const auto& info = entry.streams[i];
+        AVRational timeBase = formatCtx->streams[i]->time_base;
+        if (par->codec_type != info.codecType || par->codec_id != info.codecId) return false;
+        // 关键帧索引以流时间基记录，时间基不同则索引不可用
+        if (timeBase.num != info.timeBaseNum || timeBase.den != info.timeBaseDen) return false;
+    }
+
+    // 只补全封装头缺失的字段，头中已有的值保持不变
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        AVStream* stream = formatCtx->streams[i];
+        AVCodecParameters* par = stream->codecpar;
+        const auto& info = entry.streams[i];
+
+        if (par->format < 0) par->format = info.format;
+        if (par->width == 0 || par->height == 0) {
+            par->width = info.width;
+            par->height = info.height;
+        }
+        if (par->sample_rate == 0) par->sample_rate = info.sampleRate;
+        if (par->channels == 0) par->channels = info.channels;
+        if (par->channel_layout == 0) par->channel_layout = info.channelLayout;
+        if (par->bit_rate == 0) par->bit_rate = info.bitRate;
+        if (par->profile == FF_PROFILE_UNKNOWN) par->profile = info.profile;
+        if (par->level == FF_LEVEL_UNKNOWN) par->level = info.level;
+        if (par->sample_aspect_ratio.num == 0) {
+            par->sample_aspect_ratio = AVRational{info.sampleAspectNum, info.sampleAspectDen};
+        }
+        if (stream->avg_frame_rate.num == 0) stream->avg_frame_rate = AVRational{info.frameRateNum, info.frameRateDen};
+        if (stream->start_time == AV_NOPTS_VALUE) stream->start_time = info.startTime;
+        if (stream->duration == AV_NOPTS_VALUE) stream->duration = info.duration;
+
+        if ((!par->extradata || par->extradata_size == 0) && !info.extradata.empty()) {
+            par->extradata = static_cast<uint8_t*>(av_mallocz(info.extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+            if (!par->extradata) return false;
+            std::copy(info.extradata.begin(), info.extradata.end(), par->extradata);
+            par->extradata_size = static_cast<int>(info.extradata.size());
+        }
+    }
+    if (formatCtx->start_time == AV_NOPTS_VALUE) formatCtx->start_time = entry.startTime;
+    if (formatCtx->duration == AV_NOPTS_VALUE) formatCtx->duration = entry.duration;
+    return true;
+}
+
+}  // namespace av
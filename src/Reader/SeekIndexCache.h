@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "KeyframeIndex.h"
+
+struct AVFormatContext;
+
+namespace av {
+
+// 缓存的流参数，只记录 avformat_find_stream_info 会补全、解码器需要的字段
+struct CachedStreamInfo {
+    int codecType{-1};
+    int codecId{0};
+    int format{-1};
+    int width{0};
+    int height{0};
+    int sampleRate{0};
+    int channels{0};
+    uint64_t channelLayout{0};
+    int64_t bitRate{0};
+    int profile{0};
+    int level{0};
+    int timeBaseNum{0};
+    int timeBaseDen{1};
+    int sampleAspectNum{0};
+    int sampleAspectDen{1};
+    int frameRateNum{0};
+    int frameRateDen{1};
+    int64_t startTime{0};
+    int64_t duration{0};
+    std::vector<uint8_t> extradata;
+};
+
+struct SeekIndexCacheEntry {
+    int64_t startTime{0};
+    int64_t duration{0};
+    std::vector<CachedStreamInfo> streams;
+    std::unordered_map<int, std::vector<KeyframeEntry>> keyframes;
+};
+
+// 以文件路径、大小、修改时间为键，在磁盘上保存流参数和关键帧索引，
+// 再次打开同一文件时跳过 avformat_find_stream_info 和关键帧扫描
+class SeekIndexCache {
+public:
+    explicit SeekIndexCache(std::string cacheDir);
+
+    bool Load(const std::string& url, SeekIndexCacheEntry& entry);
+    bool Save(const std::string& url, const SeekIndexCacheEntry& entry);
+
+    // 从已探测过的 AVFormatContext 中提取流参数
+    static void CaptureStreamInfo(AVFormatContext* formatCtx, SeekIndexCacheEntry& entry);
+    // 把缓存的流参数补全到刚打开、尚未探测的 AVFormatContext，流布局不一致时返回 false
+    static bool ApplyStreamInfo(const SeekIndexCacheEntry& entry, AVFormatContext* formatCtx);
+
+private:
+    // 获取本地文件的大小和修改时间，非本地文件返回 false
+    static bool GetFileStamp(const std::string& url, int64_t& size, int64_t& modifiedTime);
+    std::string GetCachePath(const std::string& url) const;
+
+private:
+    std::string m_cacheDir;
+};
+
+}  // namespace av
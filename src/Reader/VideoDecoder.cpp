@@ -1,5 +1,7 @@
 #include "VideoDecoder.h"
 
+#include <cassert>
+
 namespace av {
 
 IVideoDecoder* IVideoDecoder::Create() {
@@ -8,6 +10,7 @@ IVideoDecoder* IVideoDecoder::Create() {
 
 
 VideoDecoder::VideoDecoder() {
+    m_frameBufferPool = std::make_shared<FrameBufferPool>();
     m_pipelineReleaseCallback = std::make_shared<std::function<void()>>([&](){
         ReleaseVideoPipelineResource();
     });
@@ -31,19 +34,21 @@ void VideoDecoder::CleanContext() {
 
 void VideoDecoder::ThreadLoop() {
     while (true) {
-        m_notifier.Wait(100);
+        // 无超时等待：新 packet、下游归还资源、启动/停止都会唤醒线程
+        m_notifier.Wait();
         if (m_abort) {
             break;
         }
+        if (m_clearRequested.exchange(false)) {
+            DiscardPackets();
+        }
+        // 有输入且下游有空闲资源时，尽可能多地连续解码
         CheckFlushPacket();
-        if (!m_paused && m_pipelineResourceCount > 0) {
-            DecodeAVPacket();
+        while (!m_abort && !m_paused && m_pipelineResourceCount > 0 && DecodeAVPacket()) {
+            CheckFlushPacket();
         }
     }
-    {
-        std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-        m_packetQueue.clear();
-    }
+    DiscardPackets();
 }
 
 void VideoDecoder::Start() {
@@ -65,23 +70,33 @@ void VideoDecoder::Stop() {
 
 int VideoDecoder::GetVideoHeight() {
     std::lock_guard<std::mutex> lock(m_codecContextMutex);
-    return m_codecContext ? m_codecContext->width : 0;
+    return m_codecContext ? m_codecContext->height : 0;
 }
 
 int VideoDecoder::GetVideoWidth() {
     std::lock_guard<std::mutex> lock(m_codecContextMutex);
-    return m_codecContext ? m_codecContext->height : 0;
+    return m_codecContext ? m_codecContext->width : 0;
 }
 
 
 void VideoDecoder::CheckFlushPacket() {
-    std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-    if (m_packetQueue.empty()) return;
-
-    auto packet = m_packetQueue.front();
-    if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-        m_packetQueue.pop_front();
-        avcodec_flush_buffers(m_codecContext);
+    // 有待处理的刷新包时，丢弃刷新包之前的所有 packet
+    while (m_pendingFlushCount > 0) {
+        auto front = m_packetQueue.Front();
+        if (!front) return;
+
+        bool isFlush = (*front)->flags & static_cast<int>(AVFrameFlag::kFlush);
+        int64_t discardBeforePts = (*front)->discardBeforePts;
+        m_packetQueue.Pop();
+        if (!isFlush) continue;
+
+        m_pendingFlushCount--;
+        m_discardBeforePts = discardBeforePts;
+        {
+            // SetStream 可能在其它线程中替换解码上下文
+            std::lock_guard<std::mutex> lock(m_codecContextMutex);
+            if (m_codecContext) avcodec_flush_buffers(m_codecContext);
+        }
 
         auto videoFrame = std::make_shared<IVideoFrame>();
         videoFrame->flags |= static_cast<int>(AVFrameFlag::kFlush);
@@ -94,10 +109,9 @@ void VideoDecoder::SetStream(struct AVStream* stream) {
     if (stream == nullptr) {
         return;
     }
-    {
-        std::lock_guard<std::mutex> lock(m_codecContextMutex);
-        m_packetQueue.clear();
-    }
+    // 队列只能由解码线程消费，这里只发出清空请求
+    m_clearRequested = true;
+    m_notifier.Notify();
     // 重置 code 和 sws 的 ctx
     std::lock_guard<std::mutex> lock(m_codecContextMutex);
     CleanContext();
@@ -118,6 +132,8 @@ void VideoDecoder::SetStream(struct AVStream* stream) {
         avcodec_free_context(&m_codecContext);
         return;
     }
+    ApplyThreadingParameters();
+
     // 打开解码器
     if (avcodec_open2(m_codecContext, codec, nullptr) < 0) {
         avcodec_free_context(&m_codecContext);
@@ -133,25 +149,42 @@ void VideoDecoder::SetListener(IVideoDecoder::Listener* listener) {
 }
 
 
-void VideoDecoder::DecodeAVPacket() {
+bool VideoDecoder::DecodeAVPacket() {
     std::shared_ptr<IAVPacket> packet;
-    {
-        std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-        if (m_packetQueue.empty()) {
-            return;
-        }
-        packet = m_packetQueue.front();
-        m_packetQueue.pop_front();
+    // 刷新包交给 CheckFlushPacket 处理
+    if (m_pendingFlushCount > 0) {
+        return false;
+    }
+    if (!m_packetQueue.TryPop(packet)) {
+        return false;
     }
     std::lock_guard<std::mutex> lock(m_codecContextMutex);
-    if (packet->avPacket && avcodec_send_packet(m_codecContext, packet->avPacket) < 0) {
+    bool isEndOfStream = packet->flags & static_cast<int>(AVFrameFlag::kEOS);
+    if (!m_codecContext) {
+        if (isEndOfStream) NotifyEndOfStream();
+        return true;
+    }
+    // skip_frame 与其它解码上下文字段一样只在持有 m_codecContextMutex 时读写；
+    // 其它线程通过 m_skipNonReferenceFrames 请求跳帧，由这里在送包前生效
+    bool skipping = m_skipNonReferenceFrames;
+    AVDiscard skipFrame = skipping ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    if (m_codecContext->skip_frame != skipFrame) {
+        m_codecContext->skip_frame = skipFrame;
+        m_skipPacketBalance = 0;
+    }
+    if (isEndOfStream) {
+        // 送入空 packet 使解码器进入冲刷模式，输出缓存中剩余的帧
+        avcodec_send_packet(m_codecContext, nullptr);
+    } else if (packet->avPacket && avcodec_send_packet(m_codecContext, packet->avPacket) < 0) {
         std::cerr << "Error sending video packet for decoding." << std::endl;
-        return;
+        return true;
+    } else if (skipping && packet->avPacket) {
+        m_skipPacketBalance++;
     }
     AVFrame* frame = av_frame_alloc();
     if (!frame) {
         std::cerr << "Could not allocate video frame." << std::endl;
-        return;
+        return true;
     }
 
 
@@ -162,50 +195,22 @@ void VideoDecoder::DecodeAVPacket() {
         } else if (ret < 0) {
             std::cerr << "Error during decoding." << std::endl;
             av_frame_free(&frame);
-            return;
+            return true;
         }
-
-        // 创建一个图像转换器，用于定义图像缩放和格式转换的参数。
-        // 转换为 AV_PIX_FMT_RGBA 格式，使用 SWS_BILINEAR(双线性插值)
-        if (!m_swsContext) {
-            m_swsContext = sws_getContext(frame->width, frame->height, (AVPixelFormat)frame->format, frame->width,
-                            frame->height, AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr);
-            if (!m_swsContext) {
-                av_frame_free(&frame);
-                return;
-            }
+        if (skipping && m_skipPacketBalance > 0) m_skipPacketBalance--;
+        // 精确跳转时目标之前的帧在颜色转换前直接丢弃
+        if (ShouldDiscardFrame(frame)) {
+            continue;
         }
 
-        AVFrame* rgbFrame = av_frame_alloc();
-        if (!rgbFrame) {
+        auto format = static_cast<AVPixelFormat>(frame->format);
+        bool isYUVFrame = format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_NV12;
+        auto videoFrame = (m_yuvOutputEnabled && isYUVFrame) ? CreateYUVVideoFrame(frame) : CreateRGBAVideoFrame(frame);
+        if (!videoFrame) {
             av_frame_free(&frame);
-            return;
+            return true;
         }
 
-        // 计算缓冲区大小
-        int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGBA, frame->width, frame->height, 1);
-        std::shared_ptr<uint8_t> buffer(new uint8_t[numBytes], std::default_delete<uint8_t[]>());
-
-        // 这个函数只是指明了 rgbFrame->data 指针应该指向的区域是 buffer，对该区域进行访问时的步长为：rgbFrame->linesize, 对数据实际是不做处理的
-        if (av_image_fill_arrays(rgbFrame->data, rgbFrame->linesize, buffer.get(), AV_PIX_FMT_RGBA, frame->width, frame->height, 1) < 0) {
-            av_frame_free(&frame);
-            av_frame_free(&rgbFrame);
-            return;
-        }
-
-        // 将图像转换为目标格式 frame->rgbframe
-        sws_scale(m_swsContext, frame->data, frame->linesize, 0, frame->height, rgbFrame->data, rgbFrame->linesize);
-        auto videoFrame = std::make_shared<IVideoFrame>();
-        videoFrame->width = frame->width;
-        videoFrame->height = frame->height;
-        videoFrame->data = std::move(buffer);
-        videoFrame->pts = frame->pts;
-        videoFrame->duration = frame->pkt_duration;
-        videoFrame->timebaseNum = m_timeBase.num;
-        videoFrame->timebaseDen = m_timeBase.den;
-        videoFrame->releaseCallback = m_pipelineReleaseCallback;
-        av_frame_free(&rgbFrame);
-
         m_pipelineResourceCount--;
         {
             std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
@@ -215,20 +220,196 @@ void VideoDecoder::DecodeAVPacket() {
         }
     }
     av_frame_free(&frame);
+    // 被跳过的非参考帧没有输出，超出解码器固有输出延迟的差额即为跳过的帧数；
+    // 固有延迟为重排序缓存的帧数，帧级多线程时每个额外线程再多缓存一帧
+    int outputDelay = m_codecContext->has_b_frames;
+    if (m_codecContext->active_thread_type & FF_THREAD_FRAME) {
+        outputDelay += std::max(m_codecContext->thread_count, 1) - 1;
+    }
+    if (skipping && m_skipPacketBalance > outputDelay) {
+        m_skipPacketBalance--;
+        m_skippedFrameCount++;
+    }
+    if (isEndOfStream) {
+        NotifyEndOfStream();
+    }
+    return true;
+}
+
+void VideoDecoder::NotifyEndOfStream() {
+    auto videoFrame = std::make_shared<IVideoFrame>();
+    videoFrame->flags |= static_cast<int>(AVFrameFlag::kEOS);
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    if (m_listener) m_listener->OnNotifyVideoFrame(videoFrame);
+}
+
+bool VideoDecoder::ShouldDiscardFrame(const AVFrame* frame) {
+    if (m_discardBeforePts == AV_NOPTS_VALUE || frame->pts == AV_NOPTS_VALUE) {
+        return false;
+    }
+    // 帧的显示区间覆盖目标时间即保留，之后的帧不再检查
+    bool beforeTarget = frame->pkt_duration > 0 ? frame->pts + frame->pkt_duration <= m_discardBeforePts
+                                                : frame->pts < m_discardBeforePts;
+    if (!beforeTarget) {
+        m_discardBeforePts = AV_NOPTS_VALUE;
+    }
+    return beforeTarget;
+}
+
+std::shared_ptr<IVideoFrame> VideoDecoder::CreateRGBAVideoFrame(AVFrame* frame) {
+    // 创建一个图像转换器，用于定义图像缩放和格式转换的参数。
+    // 转换为 AV_PIX_FMT_RGBA 格式，使用 SWS_BILINEAR(双线性插值)
+    if (!m_swsContext) {
+        m_swsContext = sws_getContext(frame->width, frame->height, (AVPixelFormat)frame->format, frame->width,
+                        frame->height, AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!m_swsContext) {
+            return nullptr;
+        }
+    }
+
+    AVFrame* rgbFrame = av_frame_alloc();
+    if (!rgbFrame) {
+        return nullptr;
+    }
+
+    // 计算缓冲区大小
+    int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGBA, frame->width, frame->height, 1);
+    std::shared_ptr<uint8_t> buffer = m_frameBufferPool->Acquire(numBytes);
+
+    // 这个函数只是指明了 rgbFrame->data 指针应该指向的区域是 buffer，对该区域进行访问时的步长为：rgbFrame->linesize, 对数据实际是不做处理的
+    if (av_image_fill_arrays(rgbFrame->data, rgbFrame->linesize, buffer.get(), AV_PIX_FMT_RGBA, frame->width, frame->height, 1) < 0) {
+        av_frame_free(&rgbFrame);
+        return nullptr;
+    }
+
+    // 将图像转换为目标格式 frame->rgbframe
+    sws_scale(m_swsContext, frame->data, frame->linesize, 0, frame->height, rgbFrame->data, rgbFrame->linesize);
+    av_frame_free(&rgbFrame);
+
+    auto videoFrame = std::make_shared<IVideoFrame>();
+    videoFrame->width = frame->width;
+    videoFrame->height = frame->height;
+    videoFrame->format = VideoPixelFormat::kRGBA;
+    videoFrame->data = std::move(buffer);
+    videoFrame->pts = frame->pts;
+    videoFrame->duration = frame->pkt_duration;
+    videoFrame->timebaseNum = m_timeBase.num;
+    videoFrame->timebaseDen = m_timeBase.den;
+    videoFrame->releaseCallback = m_pipelineReleaseCallback;
+    return videoFrame;
+}
+
+std::shared_ptr<IVideoFrame> VideoDecoder::CreateYUVVideoFrame(AVFrame* frame) {
+    // av_frame_clone 只增加底层缓冲区的引用计数，不拷贝像素数据
+    AVFrame* yuvFrame = av_frame_clone(frame);
+    if (!yuvFrame) {
+        return nullptr;
+    }
+
+    auto videoFrame = std::make_shared<IVideoFrame>();
+    videoFrame->width = frame->width;
+    videoFrame->height = frame->height;
+    videoFrame->format = frame->format == AV_PIX_FMT_NV12 ? VideoPixelFormat::kNV12 : VideoPixelFormat::kYUV420P;
+    videoFrame->avFrame = std::shared_ptr<AVFrame>(yuvFrame, [](AVFrame* f) { av_frame_free(&f); });
+    videoFrame->pts = frame->pts;
+    videoFrame->duration = frame->pkt_duration;
+    videoFrame->timebaseNum = m_timeBase.num;
+    videoFrame->timebaseDen = m_timeBase.den;
+    videoFrame->releaseCallback = m_pipelineReleaseCallback;
+    return videoFrame;
+}
+
+void VideoDecoder::SetYUVOutputEnabled(bool enabled) {
+    m_yuvOutputEnabled = enabled;
+}
+
+void VideoDecoder::SetThreadingParameters(const DecodeThreadingParameters& parameters) {
+    std::lock_guard<std::mutex> lock(m_codecContextMutex);
+    m_threadingParameters = parameters;
+}
+
+void VideoDecoder::SetSkipNonReferenceFrames(bool enabled) {
+    m_skipNonReferenceFrames = enabled;
+}
+
+uint64_t VideoDecoder::GetSkippedFrameCount() {
+    return m_skippedFrameCount;
+}
+
+int VideoDecoder::GetEffectiveThreadCount() {
+    std::lock_guard<std::mutex> lock(m_codecContextMutex);
+    return CalculateEffectiveThreadCount();
+}
+
+void VideoDecoder::ApplyThreadingParameters() {
+    if (m_threadingParameters.mode == DecodeThreadingMode::kDisabled) {
+        m_codecContext->thread_count = 1;
+        m_codecContext->thread_type = 0;
+        return;
+    }
+
+    int threadCount = m_threadingParameters.threadCount;
+    if (threadCount <= 0) {
+        // 解码线程过多收益有限且会增加帧级多线程的延迟，这里限制上限
+        threadCount = std::min(static_cast<int>(std::thread::hardware_concurrency()), 16);
+        threadCount = std::max(threadCount, 1);
+    }
+    m_codecContext->thread_count = threadCount;
+
+    switch (m_threadingParameters.mode) {
+        case DecodeThreadingMode::kFrame:
+            m_codecContext->thread_type = FF_THREAD_FRAME;
+            break;
+        case DecodeThreadingMode::kSlice:
+            m_codecContext->thread_type = FF_THREAD_SLICE;
+            break;
+        default:
+            m_codecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+            break;
+    }
+}
+
+int VideoDecoder::CalculateEffectiveThreadCount() {
+    if (!m_codecContext) return 0;
+    // active_thread_type 为 0 表示解码器不支持所请求的多线程方式，实际单线程运行
+    if (m_codecContext->active_thread_type == 0) return 1;
+    return m_codecContext->thread_count;
+}
+
+FrameBufferPoolStats VideoDecoder::GetFrameBufferPoolStats() {
+    return m_frameBufferPool->GetStats();
 }
 
 void VideoDecoder::Decode(std::shared_ptr<IAVPacket> packet) {
     if (packet == nullptr) {
         return;
     }
-    std::lock_guard<std::mutex> lock(m_packetQueueMutex);
-    if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
-        m_packetQueue.clear();
+    // 刷新包之前的 packet 由解码线程丢弃，先计数再入队，保证解码线程看到刷新包时计数已生效
+    bool isFlush = packet->flags & static_cast<int>(AVFrameFlag::kFlush);
+    if (isFlush) {
+        m_pendingFlushCount++;
+    }
+    bool pushed = m_packetQueue.TryPush(packet);
+    // 容量覆盖解复用器的积压上限，不会失败；丢弃 packet 会破坏解码直到下一个关键帧
+    assert(pushed && "packet queue overflow");
+    if (!pushed) {
+        if (isFlush) {
+            m_pendingFlushCount--;
+        }
+        std::cerr << "Video packet queue is full, packet dropped." << std::endl;
     }
-    m_packetQueue.push_back(packet);
     m_notifier.Notify();
 }
 
+void VideoDecoder::DiscardPackets() {
+    std::shared_ptr<IAVPacket> packet;
+    while (m_packetQueue.TryPop(packet)) {
+        if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
+            m_pendingFlushCount--;
+        }
+    }
+}
+
 
 void VideoDecoder::ReleaseVideoPipelineResource() {
     m_pipelineResourceCount++;
@@ -1,7 +1,10 @@
 // 忘了加上导致头文件重复包含
 #pragma once
 #include "Interface/IVideoDecoder.h"
+#include "Interface/IDeMuxer.h"
 #include "Core/SyncNotifier.h"
+#include "Core/SPSCQueue.h"
+#include "Core/FrameBufferPool.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -12,6 +15,8 @@ extern "C" {
 #include <mutex>
 #include <list>
 #include <iostream>
+#include <thread>
+#include <algorithm>
 
 namespace av {
 class VideoDecoder : public IVideoDecoder {
@@ -30,14 +35,38 @@ public:
     int GetVideoHeight() override;
     int GetVideoWidth() override;
 
+    void SetYUVOutputEnabled(bool enabled) override;
+    FrameBufferPoolStats GetFrameBufferPoolStats() override;
+
+    void SetThreadingParameters(const DecodeThreadingParameters& parameters) override;
+    int GetEffectiveThreadCount() override;
+
+    void SetSkipNonReferenceFrames(bool enabled) override;
+    uint64_t GetSkippedFrameCount() override;
+
 private:
     void CleanContext();
-    void DecodeAVPacket();
+    // 根据线程配置设置 thread_count / thread_type
+    void ApplyThreadingParameters();
+    int CalculateEffectiveThreadCount();
+    // 解码队列头部的一个 packet，队列为空时返回 false
+    bool DecodeAVPacket();
+
+    // 将解码后的 frame 封装为 IVideoFrame，YUV 模式下直接引用 frame，否则通过 sws 转为 RGBA
+    std::shared_ptr<IVideoFrame> CreateRGBAVideoFrame(AVFrame* frame);
+    std::shared_ptr<IVideoFrame> CreateYUVVideoFrame(AVFrame* frame);
+
+    // 向上层发送结束帧
+    void NotifyEndOfStream();
+    // 精确跳转时判断帧是否早于目标时间
+    bool ShouldDiscardFrame(const AVFrame* frame);
 
     void ReleaseVideoPipelineResource();
 
     void ThreadLoop();
     void CheckFlushPacket();
+    // 丢弃队列中所有 packet，只能在解码线程调用
+    void DiscardPackets();
 
 private:
     // 监听器
@@ -48,14 +77,33 @@ private:
     // 解码
     AVCodecContext* m_codecContext{nullptr};
     std::mutex m_codecContextMutex;
+    DecodeThreadingParameters m_threadingParameters;
 
     // 缩放器
     SwsContext* m_swsContext{nullptr};
     AVRational m_timeBase{AVRational{1, 1}};
 
-    // packet 队列
-    std::list<std::shared_ptr<IAVPacket>> m_packetQueue;
-    std::mutex m_packetQueueMutex;
+    // RGBA 帧缓冲池，帧释放后缓冲区回到池中复用
+    std::shared_ptr<FrameBufferPool> m_frameBufferPool;
+
+    // 是否直接输出 YUV 平面
+    std::atomic<bool> m_yuvOutputEnabled{false};
+
+    // 跳过非参考帧，下一个 packet 送入解码器前生效
+    std::atomic<bool> m_skipNonReferenceFrames{false};
+    // 跳帧期间送入的 packet 数减去输出的帧数，只在解码线程访问
+    int64_t m_skipPacketBalance{0};
+    std::atomic<uint64_t> m_skippedFrameCount{0};
+
+    // packet 队列，生产者为解复用线程，消费者为解码线程
+    // 解复用器限制了每路流未释放的 packet 数，容量覆盖该上限，并为刷新包、结束包留出余量
+    static constexpr size_t kMarkerPacketReserve = 16;
+    static constexpr size_t kPacketQueueCapacity = IDeMuxer::kMaxPendingPackets + kMarkerPacketReserve;
+    SPSCQueue<std::shared_ptr<IAVPacket>> m_packetQueue{kPacketQueueCapacity};
+    std::atomic<int> m_pendingFlushCount{0};
+    std::atomic<bool> m_clearRequested{false};
+    // 跳转目标，早于该值的帧被丢弃，只在解码线程访问
+    int64_t m_discardBeforePts{AV_NOPTS_VALUE};
 
 
     std::atomic<int> m_pipelineResourceCount{3};
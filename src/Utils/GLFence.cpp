@@ -0,0 +1,70 @@
+#include "GLFence.h"
+
+#include <QOpenGLExtraFunctions>
+#include <mutex>
+#include <vector>
+
+namespace av {
+
+namespace {
+
+// 等待中的帧可能在任意线程上释放，没有上下文时同步对象只能延迟删除
+std::mutex g_garbageMutex;
+std::vector<GLsync> g_garbage;
+
+QOpenGLExtraFunctions* CurrentFunctions() {
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    return context ? context->extraFunctions() : nullptr;
+}
+
+}  // namespace
+
+std::shared_ptr<GLFence> GLFence::Create() {
+    QOpenGLExtraFunctions* gl = CurrentFunctions();
+    if (!gl) return nullptr;
+
+    GLsync sync = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (!sync) return nullptr;
+    // 其它上下文等待前必须保证栅栏已经提交给 GPU
+    gl->glFlush();
+    return std::shared_ptr<GLFence>(new GLFence(sync));
+}
+
+GLFence::~GLFence() {
+    if (!m_sync) return;
+    if (QOpenGLExtraFunctions* gl = CurrentFunctions()) {
+        gl->glDeleteSync(m_sync);
+    } else {
+        std::lock_guard<std::mutex> lock(g_garbageMutex);
+        g_garbage.push_back(m_sync);
+    }
+}
+
+void GLFence::WaitOnGPU() {
+    if (QOpenGLExtraFunctions* gl = CurrentFunctions()) {
+        gl->glWaitSync(m_sync, 0, GL_TIMEOUT_IGNORED);
+    }
+}
+
+bool GLFence::WaitOnCPU(uint64_t timeoutNs) {
+    QOpenGLExtraFunctions* gl = CurrentFunctions();
+    if (!gl) return false;
+    GLenum status = gl->glClientWaitSync(m_sync, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void GLFence::CollectGarbage() {
+    QOpenGLExtraFunctions* gl = CurrentFunctions();
+    if (!gl) return;
+
+    std::vector<GLsync> garbage;
+    {
+        std::lock_guard<std::mutex> lock(g_garbageMutex);
+        garbage.swap(g_garbage);
+    }
+    for (GLsync sync : garbage) {
+        gl->glDeleteSync(sync);
+    }
+}
+
+}  // namespace av
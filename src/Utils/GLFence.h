@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Define/IVideoFrame.h"
+
+#include <QOpenGLContext>
+#include <memory>
+
+namespace av {
+
+// 基于 OpenGL 同步对象的帧完成标记，同一共享组内的上下文都可以等待
+class GLFence : public IVideoFrameFence {
+public:
+    // 在当前上下文的命令流中插入栅栏并提交，当前没有上下文时返回 nullptr
+    static std::shared_ptr<GLFence> Create();
+    ~GLFence() override;
+
+    void WaitOnGPU() override;
+    bool WaitOnCPU(uint64_t timeoutNs) override;
+
+    // 删除在没有当前上下文的线程中释放的同步对象，由持有上下文的线程定期调用
+    static void CollectGarbage();
+
+private:
+    explicit GLFence(GLsync sync) : m_sync(sync) {}
+
+private:
+    GLsync m_sync{nullptr};
+};
+
+}  // namespace av
@@ -0,0 +1,50 @@
+#include "GLPixelUploader.h"
+
+#include <QOpenGLExtraFunctions>
+#include <cstring>
+#include <iostream>
+
+namespace av {
+
+GLPixelUploader::~GLPixelUploader() {
+    if (QOpenGLContext::currentContext()) Destroy();
+}
+
+bool GLPixelUploader::Upload(GLuint texture, int width, int height, const uint8_t* rgbaData) {
+    if (!texture || !rgbaData) return false;
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+
+    if (!m_buffers[0]) gl->glGenBuffers(static_cast<GLsizei>(kBufferCount), m_buffers.data());
+    size_t size = static_cast<size_t>(width) * height * 4;
+    GLuint buffer = m_buffers[m_bufferIndex];
+    m_bufferIndex = (m_bufferIndex + 1) % kBufferCount;
+
+    gl->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    // 孤立旧存储：GPU 仍在读取的数据由驱动保留，新数据写入新分配的存储
+    gl->glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+    void* mapped = gl->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!mapped) {
+        std::cerr << "Could not map pixel unpack buffer." << std::endl;
+        gl->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    std::memcpy(mapped, rgbaData, size);
+    gl->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // 数据源为缓冲区偏移，调用立即返回，拷贝由 GPU 完成
+    gl->glBindTexture(GL_TEXTURE_2D, texture);
+    gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    gl->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void GLPixelUploader::Destroy() {
+    if (!m_buffers[0]) return;
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+    gl->glDeleteBuffers(static_cast<GLsizei>(kBufferCount), m_buffers.data());
+    m_buffers.fill(0);
+}
+
+}  // namespace av
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QOpenGLContext>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace av {
+
+// 通过像素解包缓冲区把系统内存中的 RGBA 数据上传到已分配存储的纹理
+// 每次上传前孤立（orphan）缓冲区存储，写入不会等待 GPU 读完上一帧；glTexSubImage2D 从缓冲区异步拷贝
+// 所有调用都需要在同一个当前上下文中进行
+class GLPixelUploader {
+public:
+    GLPixelUploader() = default;
+    ~GLPixelUploader();
+
+    // 纹理必须已按 width x height 分配存储
+    bool Upload(GLuint texture, int width, int height, const uint8_t* rgbaData);
+    // 在上下文销毁前调用
+    void Destroy();
+
+private:
+    // 轮流使用多个缓冲区，驱动不支持孤立优化时也能减少等待
+    static constexpr size_t kBufferCount = 2;
+    std::array<GLuint, kBufferCount> m_buffers{};
+    size_t m_bufferIndex{0};
+};
+
+}  // namespace av
@@ -0,0 +1,133 @@
+#include "GLProgramCache.h"
+
+#include <QOpenGLExtraFunctions>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifndef CACHE_DIR
+#define CACHE_DIR "cache"
+#endif
+
+namespace av {
+
+namespace {
+
+constexpr const char* kCacheMagic = "avplayer-program-binary";
+constexpr int kCacheVersion = 2;
+
+std::string GetGLString(QOpenGLExtraFunctions* gl, GLenum name) {
+    auto value = reinterpret_cast<const char*>(gl->glGetString(name));
+    return value ? value : "";
+}
+
+}  // namespace
+
+bool GLProgramCache::IsSupported() {
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    // 3.3 核心上下文中程序二进制相关的函数和枚举只能通过扩展使用
+    auto version = context->format().version();
+    bool core = context->isOpenGLES() ? version >= qMakePair(3, 0) : version >= qMakePair(4, 1);
+    if (!core && !context->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary"))) return false;
+
+    QOpenGLExtraFunctions* gl = context->extraFunctions();
+    GLint formatCount = 0;
+    gl->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
+
+std::string GLProgramCache::GetCacheKey(const char* vertexShaderSource, const char* fragmentShaderSource) {
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+    // 程序二进制只对生成它的驱动有效，驱动信息也是键的一部分
+    return std::string(vertexShaderSource) + '\0' + fragmentShaderSource + '\0' + GetGLString(gl, GL_VENDOR) +
+           '\0' + GetGLString(gl, GL_RENDERER) + '\0' + GetGLString(gl, GL_VERSION);
+}
+
+std::string GLProgramCache::GetCachePath(const std::string& key) {
+    std::ostringstream name;
+    name << std::hex << std::hash<std::string>{}(key) << ".bin";
+    return std::string(CACHE_DIR) + "/shader_program/" + name.str();
+}
+
+GLuint GLProgramCache::Load(const char* vertexShaderSource, const char* fragmentShaderSource) {
+    if (!IsSupported()) return 0;
+
+    std::string key = GetCacheKey(vertexShaderSource, fragmentShaderSource);
+    std::ifstream file(std::filesystem::u8path(GetCachePath(key)), std::ios::binary);
+    if (!file) return 0;
+
+    std::string magic;
+    int version = 0;
+    GLenum binaryFormat = 0;
+    size_t keyLength = 0;
+    size_t length = 0;
+    file >> magic >> version >> binaryFormat >> keyLength >> length;
+    file.ignore();
+    if (!file || magic != kCacheMagic || version != kCacheVersion || length == 0) return 0;
+
+    // 文件名只是哈希，键不一致说明是其它源码或驱动生成的程序
+    if (keyLength != key.size()) return 0;
+    std::string storedKey(keyLength, '\0');
+    if (!file.read(storedKey.data(), static_cast<std::streamsize>(keyLength)) || storedKey != key) return 0;
+
+    std::vector<char> binary(length);
+    if (!file.read(binary.data(), static_cast<std::streamsize>(length))) return 0;
+
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+    GLuint program = gl->glCreateProgram();
+    gl->glProgramBinary(program, binaryFormat, binary.data(), static_cast<GLsizei>(length));
+
+    // 驱动可以拒绝旧的二进制，此时回退到编译源码
+    GLint success = 0;
+    gl->glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        gl->glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+bool GLProgramCache::Save(GLuint program, const char* vertexShaderSource, const char* fragmentShaderSource) {
+    if (!IsSupported()) return false;
+
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+    GLint length = 0;
+    gl->glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum binaryFormat = 0;
+    gl->glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+    if (length <= 0) return false;
+
+    std::string key = GetCacheKey(vertexShaderSource, fragmentShaderSource);
+    auto cachePath = std::filesystem::u8path(GetCachePath(key));
+    std::error_code ec;
+    std::filesystem::create_directories(cachePath.parent_path(), ec);
+
+    // 先写临时文件再替换，避免中途退出留下不完整的缓存
+    auto tempPath = cachePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file << kCacheMagic << ' ' << kCacheVersion << ' ' << binaryFormat << ' ' << key.size() << ' ' << length
+             << '\n';
+        file.write(key.data(), static_cast<std::streamsize>(key.size()));
+        file.write(binary.data(), length);
+        if (!file) return false;
+    }
+
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        std::cerr << "Could not save program binary cache: " << cachePath.u8string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace av
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QOpenGLContext>
+#include <string>
+
+namespace av {
+
+// 着色器程序二进制缓存
+// 以着色器源码和驱动信息的哈希为文件名保存在 CACHE_DIR 下，文件中同时保存完整的键，加载时逐字节比对，
+// 驱动升级、源码修改或哈希冲突时都不会加载错误的程序
+class GLProgramCache {
+public:
+    // 需要当前上下文，命中时返回已链接的程序，否则返回 0
+    static GLuint Load(const char* vertexShaderSource, const char* fragmentShaderSource);
+    // 需要当前上下文，程序链接前应设置 GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    static bool Save(GLuint program, const char* vertexShaderSource, const char* fragmentShaderSource);
+    // 当前上下文是否支持程序二进制（OpenGL 4.1 / ES 3.0 核心，或 GL_ARB_get_program_binary 扩展）
+    static bool IsSupported();
+
+private:
+    // 着色器源码与驱动信息拼接成的完整键
+    static std::string GetCacheKey(const char* vertexShaderSource, const char* fragmentShaderSource);
+    static std::string GetCachePath(const std::string& key);
+};
+
+}  // namespace av
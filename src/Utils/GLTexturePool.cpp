@@ -0,0 +1,141 @@
+#include "GLTexturePool.h"
+
+#include <QOpenGLFunctions>
+
+#include "GLUtils.h"
+
+namespace av {
+
+namespace {
+
+// 池清空或销毁后才归还的纹理，归还线程没有上下文时延迟到 CollectGarbage 删除
+std::mutex g_garbageMutex;
+std::vector<GLuint> g_garbage;
+
+void DeleteOrphanTexture(GLuint texture) {
+    if (QOpenGLContext* context = QOpenGLContext::currentContext()) {
+        context->functions()->glDeleteTextures(1, &texture);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_garbageMutex);
+    g_garbage.push_back(texture);
+}
+
+bool FencesSignaled(const VideoFrameFences& fences) {
+    for (auto& fence : fences) {
+        if (fence && !fence->WaitOnCPU(0)) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+std::shared_ptr<GLTexturePool> GLTexturePool::Create(size_t maxFreeCount) {
+    return std::shared_ptr<GLTexturePool>(new GLTexturePool(maxFreeCount));
+}
+
+GLTexturePool::~GLTexturePool() {
+    // 析构时可能没有当前上下文，纹理应已通过 Clear 删除
+    if (QOpenGLContext::currentContext()) Clear();
+}
+
+GLuint GLTexturePool::Acquire(int width, int height, GLenum internalFormat, GLenum format) {
+    CollectGarbage();
+
+    std::vector<GLuint> pendingDeletes;
+    FreeTexture freeTexture;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cleared = false;
+        pendingDeletes.swap(m_pendingDeletes);
+
+        auto it = m_freeTextures.find(Key(width, height, internalFormat));
+        if (it != m_freeTextures.end() && !it->second.empty()) {
+            // 优先取使用者已经完成的纹理，都未完成时取最早归还的
+            auto& textures = it->second;
+            auto ready = textures.begin();
+            while (ready != textures.end() && !FencesSignaled(ready->fences)) ++ready;
+            if (ready == textures.end()) ready = textures.begin();
+            freeTexture = std::move(*ready);
+            textures.erase(ready);
+        }
+    }
+    DeleteTextures(pendingDeletes);
+    if (!freeTexture.texture) return GLUtils::GenerateTexture(width, height, internalFormat, format);
+
+    // 之后对纹理的写入在 GPU 上排在使用者的采样之后，不阻塞调用线程
+    for (auto& fence : freeTexture.fences) {
+        if (fence) fence->WaitOnGPU();
+    }
+    return freeTexture.texture;
+}
+
+void GLTexturePool::Release(GLuint texture, int width, int height, GLenum internalFormat, VideoFrameFences fences) {
+    if (!texture) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_cleared) {
+            auto& textures = m_freeTextures[Key(width, height, internalFormat)];
+            if (textures.size() < m_maxFreeCount) {
+                textures.push_back(FreeTexture{texture, std::move(fences)});
+            } else {
+                m_pendingDeletes.push_back(texture);
+            }
+            return;
+        }
+    }
+    DeleteOrphanTexture(texture);
+}
+
+void GLTexturePool::AcquireForFrame(IVideoFrame& frame, GLenum internalFormat, GLenum format) {
+    int width = static_cast<int>(frame.width);
+    int height = static_cast<int>(frame.height);
+    frame.textureId = Acquire(width, height, internalFormat, format);
+
+    // 池先于帧销毁时纹理由持有共享上下文的线程删除
+    std::weak_ptr<GLTexturePool> weakPool = shared_from_this();
+    frame.textureReleaseCallback = [weakPool, width, height, internalFormat](unsigned int texture,
+                                                                             VideoFrameFences fences) {
+        if (auto pool = weakPool.lock()) {
+            pool->Release(texture, width, height, internalFormat, std::move(fences));
+        } else {
+            DeleteOrphanTexture(texture);
+        }
+    };
+}
+
+void GLTexturePool::Clear() {
+    std::vector<GLuint> textures;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cleared = true;
+        textures.swap(m_pendingDeletes);
+        for (auto& [key, freeTextures] : m_freeTextures) {
+            for (auto& freeTexture : freeTextures) textures.push_back(freeTexture.texture);
+        }
+        m_freeTextures.clear();
+    }
+    DeleteTextures(textures);
+    CollectGarbage();
+}
+
+void GLTexturePool::CollectGarbage() {
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (!context) return;
+
+    std::vector<GLuint> garbage;
+    {
+        std::lock_guard<std::mutex> lock(g_garbageMutex);
+        garbage.swap(g_garbage);
+    }
+    if (!garbage.empty()) context->functions()->glDeleteTextures(static_cast<GLsizei>(garbage.size()), garbage.data());
+}
+
+void GLTexturePool::DeleteTextures(std::vector<GLuint>& textures) {
+    if (textures.empty()) return;
+    QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+    gl->glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+    textures.clear();
+}
+
+}  // namespace av
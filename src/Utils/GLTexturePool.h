@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Define/IVideoFrame.h"
+
+#include <QOpenGLContext>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace av {
+
+// 按尺寸和格式复用的纹理池
+// 纹理在持有共享上下文的线程中创建，可以从任意线程归还；帧释放时把当前持有的纹理交还给池
+// 归还时附带使用者的完成标记，Acquire 优先取出使用者已完成的纹理，否则让当前上下文在 GPU 上等待，
+// 保证复用纹理的写入不会覆盖其它上下文仍在采样的内容
+class GLTexturePool : public std::enable_shared_from_this<GLTexturePool> {
+public:
+    // maxFreeCount 为每种尺寸/格式最多保留的空闲纹理数，超出的纹理在下一次 Acquire 时删除
+    static std::shared_ptr<GLTexturePool> Create(size_t maxFreeCount = 8);
+    ~GLTexturePool();
+
+    // 需要当前上下文
+    GLuint Acquire(int width, int height, GLenum internalFormat = GL_RGBA, GLenum format = GL_RGBA);
+    // 可在任意线程调用，fences 为仍可能在采样该纹理的使用者的完成标记
+    void Release(GLuint texture, int width, int height, GLenum internalFormat = GL_RGBA,
+                 VideoFrameFences fences = VideoFrameFences());
+
+    // 从池中为帧分配纹理，帧释放时纹理自动归还
+    // 帧在处理中交换 textureId 时只能与同尺寸、同格式的池内纹理交换
+    void AcquireForFrame(IVideoFrame& frame, GLenum internalFormat = GL_RGBA, GLenum format = GL_RGBA);
+
+    // 需要当前上下文，删除所有空闲纹理，通常在上下文销毁前调用
+    // 之后归还的纹理（显示、编码仍持有的帧）不再入池，由 CollectGarbage 删除
+    void Clear();
+
+    // 删除在没有当前上下文的线程中被丢弃的纹理（池已清空或已销毁），由持有共享上下文的线程定期调用
+    static void CollectGarbage();
+
+private:
+    explicit GLTexturePool(size_t maxFreeCount) : m_maxFreeCount(maxFreeCount) {}
+    void DeleteTextures(std::vector<GLuint>& textures);
+
+private:
+    using Key = std::tuple<int, int, GLenum>;
+    struct FreeTexture {
+        GLuint texture{0};
+        VideoFrameFences fences;
+    };
+
+    const size_t m_maxFreeCount;
+    std::mutex m_mutex;
+    std::map<Key, std::vector<FreeTexture>> m_freeTextures;
+    std::vector<GLuint> m_pendingDeletes;  // 归还时超出上限的纹理，等待在有上下文的线程中删除
+    bool m_cleared{false};
+};
+
+}  // namespace av
@@ -1,5 +1,7 @@
 #include "GLUtils.h"
+#include "GLProgramCache.h"
 #include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
 #include <QImage>
 #include <QDebug>
 
@@ -25,6 +27,9 @@ unsigned int GLUtils::CompileShader(unsigned int type, const char* source) {
 }
 
 unsigned int GLUtils::CompileAndLinkProgram(const char* vertexShaderSource, const char* fragmentShaderSource) {
+    // 优先使用缓存的程序二进制，省去编译和链接
+    if (auto cachedProgram = GLProgramCache::Load(vertexShaderSource, fragmentShaderSource)) return cachedProgram;
+
     QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
     
     auto vertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
@@ -32,6 +37,12 @@ unsigned int GLUtils::CompileAndLinkProgram(const char* vertexShaderSource, cons
     auto shaderProgram = gl->glCreateProgram();
     gl->glAttachShader(shaderProgram, vertexShader);
     gl->glAttachShader(shaderProgram, fragmentShader);
+    // 不支持程序二进制的上下文（例如没有扩展的 3.3 核心）不能设置该参数，也不写缓存
+    bool cacheable = GLProgramCache::IsSupported();
+    if (cacheable) {
+        QOpenGLContext::currentContext()->extraFunctions()->glProgramParameteri(
+            shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     gl->glLinkProgram(shaderProgram);
     
     // 检查链接状态
@@ -41,6 +52,8 @@ unsigned int GLUtils::CompileAndLinkProgram(const char* vertexShaderSource, cons
     if (!success) {
         gl->glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
         std::cerr << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    } else if (cacheable) {
+        GLProgramCache::Save(shaderProgram, vertexShaderSource, fragmentShaderSource);
     }
     
     gl->glDeleteShader(vertexShader);
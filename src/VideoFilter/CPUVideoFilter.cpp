@@ -0,0 +1,170 @@
+#include "CPUVideoFilter.h"
+
+#include <algorithm>
+#include <iostream>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+namespace av {
+
+namespace {
+
+// 与 GrayFilter 着色器相同的 BT.601 亮度权重，定点数计算
+class CPUGrayFilter : public CPUVideoFilter {
+public:
+    CPUGrayFilter() : CPUVideoFilter(VideoFilterType::kGray) {}
+
+    bool Process(IVideoFrame& frame) override {
+        uint8_t* pixel = frame.data.get();
+        size_t count = static_cast<size_t>(frame.width) * frame.height;
+        for (size_t i = 0; i < count; ++i, pixel += 4) {
+            auto gray = static_cast<uint8_t>((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2]) >> 8);
+            pixel[0] = pixel[1] = pixel[2] = gray;
+        }
+        return true;
+    }
+};
+
+class CPUInvertFilter : public CPUVideoFilter {
+public:
+    CPUInvertFilter() : CPUVideoFilter(VideoFilterType::kInvert) {}
+
+    bool Process(IVideoFrame& frame) override {
+        uint8_t* pixel = frame.data.get();
+        size_t count = static_cast<size_t>(frame.width) * frame.height;
+        for (size_t i = 0; i < count; ++i, pixel += 4) {
+            pixel[0] = 255 - pixel[0];
+            pixel[1] = 255 - pixel[1];
+            pixel[2] = 255 - pixel[2];
+        }
+        return true;
+    }
+};
+
+class CPUFlipVerticalFilter : public CPUVideoFilter {
+public:
+    CPUFlipVerticalFilter() : CPUVideoFilter(VideoFilterType::kFlipVertical) {}
+
+    bool Process(IVideoFrame& frame) override {
+        size_t stride = static_cast<size_t>(frame.width) * 4;
+        uint8_t* top = frame.data.get();
+        uint8_t* bottom = top + stride * (frame.height - 1);
+        for (; top < bottom; top += stride, bottom -= stride) {
+            std::swap_ranges(top, top + stride, bottom);
+        }
+        return true;
+    }
+};
+
+}  // namespace
+
+CPUVideoFilter* CPUVideoFilter::Create(VideoFilterType type) {
+    switch (type) {
+        case VideoFilterType::kGray:
+            return new CPUGrayFilter();
+        case VideoFilterType::kInvert:
+            return new CPUInvertFilter();
+        case VideoFilterType::kFlipVertical:
+            return new CPUFlipVerticalFilter();
+        default:
+            return nullptr;
+    }
+}
+
+void CPUVideoFilter::SetFloat(const std::string& name, float value) {
+    std::lock_guard<std::mutex> lock(m_valuesMutex);
+    m_floatValues[name] = value;
+}
+
+float CPUVideoFilter::GetFloat(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_valuesMutex);
+    return m_floatValues[name];
+}
+
+void CPUVideoFilter::SetInt(const std::string& name, int value) {
+    std::lock_guard<std::mutex> lock(m_valuesMutex);
+    m_intValues[name] = value;
+}
+
+int CPUVideoFilter::GetInt(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_valuesMutex);
+    return m_intValues[name];
+}
+
+void CPUVideoFilter::SetString(const std::string& name, const std::string& value) {
+    std::lock_guard<std::mutex> lock(m_valuesMutex);
+    m_stringValues[name] = value;
+}
+
+std::string CPUVideoFilter::GetString(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_valuesMutex);
+    return m_stringValues[name];
+}
+
+CPUVideoFilterChain::CPUVideoFilterChain() : m_frameBufferPool(std::make_shared<FrameBufferPool>()) {}
+
+CPUVideoFilterChain::~CPUVideoFilterChain() {
+    if (m_swsContext) sws_freeContext(m_swsContext);
+}
+
+std::shared_ptr<IVideoFilter> CPUVideoFilterChain::AddVideoFilter(VideoFilterType type) {
+    auto filter = std::shared_ptr<CPUVideoFilter>(CPUVideoFilter::Create(type));
+    if (!filter) {
+        std::cerr << "Video filter type " << static_cast<int>(type) << " is not supported on the CPU backend."
+                  << std::endl;
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_filters.push_back(filter);
+    return filter;
+}
+
+void CPUVideoFilterChain::RemoveVideoFilter(VideoFilterType type) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_filters.remove_if([type](const std::shared_ptr<CPUVideoFilter>& filter) { return filter->GetType() == type; });
+}
+
+bool CPUVideoFilterChain::Empty() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_filters.empty();
+}
+
+void CPUVideoFilterChain::Process(std::shared_ptr<IVideoFrame> frame) {
+    if (!frame || frame->width == 0 || frame->height == 0) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_filters.empty()) return;
+    if (frame->format != VideoPixelFormat::kRGBA && !ConvertToRGBA(*frame)) return;
+    if (!frame->data) return;
+
+    for (auto& filter : m_filters) {
+        filter->Process(*frame);
+    }
+}
+
+bool CPUVideoFilterChain::ConvertToRGBA(IVideoFrame& frame) {
+    AVFrame* avFrame = frame.avFrame.get();
+    if (!avFrame) return false;
+
+    int width = static_cast<int>(frame.width);
+    int height = static_cast<int>(frame.height);
+    m_swsContext = sws_getCachedContext(m_swsContext, width, height, static_cast<AVPixelFormat>(avFrame->format),
+                                        width, height, AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!m_swsContext) return false;
+
+    auto buffer = m_frameBufferPool->Acquire(av_image_get_buffer_size(AV_PIX_FMT_RGBA, width, height, 1));
+    uint8_t* dstData[4] = {buffer.get(), nullptr, nullptr, nullptr};
+    int dstLinesize[4] = {width * 4, 0, 0, 0};
+    sws_scale(m_swsContext, avFrame->data, avFrame->linesize, 0, height, dstData, dstLinesize);
+
+    frame.data = std::move(buffer);
+    frame.format = VideoPixelFormat::kRGBA;
+    frame.avFrame = nullptr;
+    return true;
+}
+
+}  // namespace av
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Core/FrameBufferPool.h"
+#include "Define/IVideoFrame.h"
+#include "IVideoFilter.h"
+
+struct SwsContext;
+
+namespace av {
+
+// 在系统内存中处理 RGBA 帧的滤镜，用于没有 OpenGL 环境的无界面引擎
+class CPUVideoFilter : public IVideoFilter {
+public:
+    ~CPUVideoFilter() override = default;
+
+    VideoFilterType GetType() const override { return m_type; }
+
+    void SetFloat(const std::string& name, float value) override;
+    float GetFloat(const std::string& name) override;
+
+    void SetInt(const std::string& name, int value) override;
+    int GetInt(const std::string& name) override;
+
+    void SetString(const std::string& name, const std::string& value) override;
+    std::string GetString(const std::string& name) override;
+
+    // 原地处理 RGBA 帧
+    virtual bool Process(IVideoFrame& frame) = 0;
+
+    // 不支持的类型（如依赖人脸检测的贴纸）返回 nullptr
+    static CPUVideoFilter* Create(VideoFilterType type);
+
+protected:
+    explicit CPUVideoFilter(VideoFilterType type) : m_type(type) {}
+
+protected:
+    VideoFilterType m_type{VideoFilterType::kNone};
+    std::mutex m_valuesMutex;
+    std::unordered_map<std::string, float> m_floatValues;
+    std::unordered_map<std::string, int> m_intValues;
+    std::unordered_map<std::string, std::string> m_stringValues;
+};
+
+// CPU 滤镜链，YUV 帧在需要滤镜处理时才转换为 RGBA
+class CPUVideoFilterChain {
+public:
+    CPUVideoFilterChain();
+    ~CPUVideoFilterChain();
+
+    std::shared_ptr<IVideoFilter> AddVideoFilter(VideoFilterType type);
+    void RemoveVideoFilter(VideoFilterType type);
+    bool Empty();
+
+    void Process(std::shared_ptr<IVideoFrame> frame);
+
+private:
+    bool ConvertToRGBA(IVideoFrame& frame);
+
+private:
+    std::mutex m_mutex;
+    std::list<std::shared_ptr<CPUVideoFilter>> m_filters;
+
+    // 只在处理线程访问
+    SwsContext* m_swsContext{nullptr};
+    std::shared_ptr<FrameBufferPool> m_frameBufferPool;
+};
+
+}  // namespace av
@@ -0,0 +1,173 @@
+#include "FaceDetector.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace av {
+
+namespace {
+
+constexpr int kMaxDetectFaceNum = 4;
+constexpr float kDegreesToRadians = 3.14159265f / 180.0f;
+
+// InspireFace 的资源是进程级的，只能加载一次
+std::mutex g_launchMutex;
+std::string g_launchedModelPath;
+
+}  // namespace
+
+FaceDetector::FaceDetector() : m_thread(&FaceDetector::ThreadLoop, this) {}
+
+FaceDetector::~FaceDetector() {
+    m_abort = true;
+    m_notifier.Notify();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void FaceDetector::SetModelPath(const std::string& modelPath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_modelPath == modelPath) return;
+    m_modelPath = modelPath;
+    m_modelChanged = true;
+}
+
+void FaceDetector::SubmitFrame(std::vector<uint8_t> rgbaData, int width, int height, Clock::time_point timestamp) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingData = std::move(rgbaData);
+        m_pendingWidth = width;
+        m_pendingHeight = height;
+        m_pendingTimestamp = timestamp;
+        m_hasPendingFrame = true;
+    }
+    m_notifier.Notify();
+}
+
+bool FaceDetector::GetResults(Result& previous, Result& latest) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_resultCount == 0) return false;
+    previous = m_resultCount > 1 ? m_previousResult : m_latestResult;
+    latest = m_latestResult;
+    return true;
+}
+
+void FaceDetector::ThreadLoop() {
+    std::vector<uint8_t> rgbaData;
+    while (!m_abort) {
+        int width = 0;
+        int height = 0;
+        Clock::time_point timestamp;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_hasPendingFrame) {
+                rgbaData.swap(m_pendingData);
+                width = m_pendingWidth;
+                height = m_pendingHeight;
+                timestamp = m_pendingTimestamp;
+                m_hasPendingFrame = false;
+            }
+        }
+        if (width == 0 || height == 0) {
+            m_notifier.Wait();
+            continue;
+        }
+        if (EnsureSession()) Detect(rgbaData, width, height, timestamp);
+    }
+
+    if (m_session) HFReleaseInspireFaceSession(m_session);
+    m_session = nullptr;
+}
+
+bool FaceDetector::EnsureSession() {
+    std::string modelPath;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_modelChanged) return m_session != nullptr;
+        m_modelChanged = false;
+        modelPath = m_modelPath;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_launchMutex);
+        if (g_launchedModelPath.empty()) {
+            if (HFLaunchInspireFace(modelPath.c_str()) != HSUCCEED) {
+                std::cerr << "Failed to load face detection model: " << modelPath << std::endl;
+                return false;
+            }
+            g_launchedModelPath = modelPath;
+        } else if (g_launchedModelPath != modelPath) {
+            std::cerr << "Face detection model is already loaded from " << g_launchedModelPath << std::endl;
+        }
+    }
+
+    if (m_session) return true;
+    HFSessionCustomParameter parameter = {0};
+    // 视频跟踪模式，连续帧之间复用跟踪结果，比逐帧检测更快也更稳定
+    if (HFCreateInspireFaceSession(parameter, HF_DETECT_MODE_LIGHT_TRACK, kMaxDetectFaceNum, -1, -1, &m_session) !=
+        HSUCCEED) {
+        std::cerr << "Failed to create face detection session." << std::endl;
+        m_session = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void FaceDetector::Detect(std::vector<uint8_t>& rgbaData, int width, int height, Clock::time_point timestamp) {
+    HFImageData imageData = {0};
+    imageData.data = rgbaData.data();
+    imageData.width = width;
+    imageData.height = height;
+    imageData.format = HF_STREAM_RGBA;
+    imageData.rotation = HF_CAMERA_ROTATION_0;
+
+    HFImageStream stream = nullptr;
+    if (HFCreateImageStream(&imageData, &stream) != HSUCCEED) return;
+
+    Result result;
+    result.timestamp = timestamp;
+    HFMultipleFaceData faceData = {0};
+    if (HFExecuteFaceTrack(m_session, stream, &faceData) == HSUCCEED) {
+        HInt32 landmarkCount = 0;
+        HFGetNumOfFaceDenseLandmark(&landmarkCount);
+        std::vector<HPoint2f> landmarks(landmarkCount > 0 ? landmarkCount : 0);
+
+        for (int i = 0; i < faceData.detectedNum; ++i) {
+            const HFaceRect& rect = faceData.rects[i];
+            Face face;
+            face.trackId = faceData.trackIds[i];
+            face.roll = faceData.angles.roll[i];
+            face.yaw = faceData.angles.yaw[i];
+            face.pitch = faceData.angles.pitch[i];
+
+            // 由人脸框和翻滚角估计双眼位置：眼睛位于框中心上方，左右各占框宽的 0.2
+            glm::vec2 center(rect.x + rect.width * 0.5f, rect.y + rect.height * 0.5f);
+            float angle = face.roll * kDegreesToRadians;
+            glm::vec2 axisX(std::cos(angle), std::sin(angle));
+            glm::vec2 axisY(-axisX.y, axisX.x);
+            glm::vec2 eyeCenter = center - axisY * (rect.height * 0.1f);
+            face.leftEye = eyeCenter - axisX * (rect.width * 0.2f);
+            face.rightEye = eyeCenter + axisX * (rect.width * 0.2f);
+
+            if (!landmarks.empty() &&
+                HFGetFaceDenseLandmarkFromFaceToken(faceData.tokens[i], landmarks.data(), landmarkCount) == HSUCCEED) {
+                face.keyPoints.reserve(landmarks.size());
+                for (const auto& point : landmarks) {
+                    face.keyPoints.emplace_back(point.x / width, point.y / height);
+                }
+            }
+
+            glm::vec2 size(static_cast<float>(width), static_cast<float>(height));
+            face.leftEye /= size;
+            face.rightEye /= size;
+            result.faces.push_back(std::move(face));
+        }
+    }
+    HFReleaseImageStream(stream);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_previousResult = std::move(m_latestResult);
+    m_latestResult = std::move(result);
+    ++m_resultCount;
+}
+
+}  // namespace av
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core/SyncNotifier.h"
+#include "inspireface.h"
+
+namespace av {
+
+// 在独立线程中运行 InspireFace 人脸跟踪，渲染线程只提交图像、读取最近的结果，不会被检测阻塞
+// 只保留最新提交的一帧，检测跟不上时旧帧直接丢弃
+class FaceDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 坐标均归一化到 [0, 1]，原点为画面左上角
+    struct Face {
+        int trackId{-1};
+        glm::vec2 leftEye{0.0f};
+        glm::vec2 rightEye{0.0f};
+        float roll{0.0f};
+        float yaw{0.0f};
+        float pitch{0.0f};
+        std::vector<glm::vec2> keyPoints;
+    };
+
+    struct Result {
+        Clock::time_point timestamp;  // 提交图像的时间
+        std::vector<Face> faces;
+    };
+
+    FaceDetector();
+    ~FaceDetector();
+
+    // 模型在检测线程中加载，可以随时调用
+    void SetModelPath(const std::string& modelPath);
+    // rgbaData 首行为画面顶部
+    void SubmitFrame(std::vector<uint8_t> rgbaData, int width, int height, Clock::time_point timestamp);
+    // 取得最近两次检测结果，用于在两次检测之间推算人脸位置；还没有结果时返回 false
+    bool GetResults(Result& previous, Result& latest);
+
+private:
+    void ThreadLoop();
+    bool EnsureSession();
+    void Detect(std::vector<uint8_t>& rgbaData, int width, int height, Clock::time_point timestamp);
+
+private:
+    std::mutex m_mutex;
+    std::string m_modelPath;
+    bool m_modelChanged{false};
+
+    // 待检测的最新一帧
+    std::vector<uint8_t> m_pendingData;
+    int m_pendingWidth{0};
+    int m_pendingHeight{0};
+    Clock::time_point m_pendingTimestamp;
+    bool m_hasPendingFrame{false};
+
+    Result m_previousResult;
+    Result m_latestResult;
+    int m_resultCount{0};
+
+    HFSession m_session{nullptr};
+
+    std::atomic<bool> m_abort{false};
+    SyncNotifier m_notifier;
+    std::thread m_thread;
+};
+
+}  // namespace av
@@ -23,6 +23,7 @@ FlipVerticalFilter::FlipVerticalFilter() {
             FragColor = texture(u_texture, v_texCoord);
         }
     )";
+    m_description.fusedTexCoordSnippet = "texCoord.y = 1.0 - texCoord.y;";
 }
 
 
@@ -0,0 +1,54 @@
+#include "FusedVideoFilter.h"
+
+namespace av {
+
+namespace {
+
+const char* kVertexShaderSource = R"(
+    #version 330 core
+    layout(location = 0) in vec2 a_position;
+    layout(location = 1) in vec2 a_texCoord;
+    out vec2 v_texCoord;
+    void main() {
+        gl_Position = vec4(a_position, 0.0, 1.0);
+        v_texCoord = a_texCoord;
+    }
+)";
+
+}  // namespace
+
+FusedVideoFilter::FusedVideoFilter(const std::vector<std::shared_ptr<VideoFilter>>& filters) {
+    std::string source = R"(
+    #version 330 core
+    in vec2 v_texCoord;
+    out vec4 FragColor;
+    uniform sampler2D u_texture;
+    void main() {
+        vec2 texCoord = v_texCoord;
+)";
+    // 坐标变换作用于输出像素到输入像素的映射，需要按相反顺序执行
+    for (auto it = filters.rbegin(); it != filters.rend(); ++it) {
+        if (auto snippet = (*it)->GetFusedTexCoordSnippet()) source += std::string("        { ") + snippet + " }\n";
+    }
+    source += "        vec4 color = texture(u_texture, texCoord);\n";
+    for (auto& filter : filters) {
+        if (auto snippet = filter->GetFusedColorSnippet()) source += std::string("        { ") + snippet + " }\n";
+    }
+    source += "        FragColor = color;\n    }\n";
+    m_fragmentShaderSource = std::move(source);
+
+    m_description.type = VideoFilterType::kNone;
+    m_description.vertexShaderSource = kVertexShaderSource;
+    m_description.fragmentShaderSource = m_fragmentShaderSource.c_str();
+}
+
+std::string FusedVideoFilter::GetChainKey(const std::vector<std::shared_ptr<VideoFilter>>& filters) {
+    std::string key;
+    for (auto& filter : filters) {
+        key += std::to_string(static_cast<int>(filter->GetType()));
+        key += ',';
+    }
+    return key;
+}
+
+}  // namespace av
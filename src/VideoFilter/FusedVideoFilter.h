@@ -0,0 +1,20 @@
+#pragma once
+
+#include "VideoFilter.h"
+
+#include <vector>
+
+namespace av {
+// 将多个逐像素滤镜的片段拼接为一个着色器，一次绘制完成整段滤镜链
+class FusedVideoFilter : public VideoFilter {
+public:
+    // filters 中的滤镜必须都是可合并的
+    explicit FusedVideoFilter(const std::vector<std::shared_ptr<VideoFilter>>& filters);
+
+    // 滤镜链的缓存键，由各滤镜类型按顺序组成
+    static std::string GetChainKey(const std::vector<std::shared_ptr<VideoFilter>>& filters);
+
+private:
+    std::string m_fragmentShaderSource;
+};
+}  // namespace av
@@ -25,6 +25,7 @@ GrayFilter::GrayFilter() {
             FragColor = vec4(gray, gray, gray, color.a);
         }
     )";
+    m_description.fusedColorSnippet = "color.rgb = vec3(dot(color.rgb, vec3(0.299, 0.587, 0.114)));";
 }
 
 
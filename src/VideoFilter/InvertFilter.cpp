@@ -24,6 +24,7 @@ InvertFilter::InvertFilter() {
             FragColor = vec4(1.0 - color.r, 1.0 - color.g, 1.0 - color.b, color.a);
         }
     )";
+    m_description.fusedColorSnippet = "color.rgb = 1.0 - color.rgb;";
 }
 
 }  // namespace av
\ No newline at end of file
@@ -1,141 +1,372 @@
-#include "VideoFilter.h"
+#include "StickerFilter.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
-#include "FlipVerticalFilter.h"
-#include "GrayFilter.h"
-#include "InvertFilter.h"
-#include "StickerFilter.h"
 #include "Utils/GLUtils.h"
 
 namespace av {
 
-VideoFilter::~VideoFilter() {
-    glDeleteProgram(m_shaderProgram);
-    glDeleteVertexArrays(1, &m_vao);
-    glDeleteBuffers(1, &m_vbo);
-}
+namespace {
 
-void VideoFilter::SetFloat(const std::string& name, float value) { m_floatValues[name] = value; }
+constexpr float kDegreesToRadians = 3.14159265f / 180.0f;
+// 贴纸半宽相对于两眼间距的比例
+constexpr float kStickerScale = 1.2f;
+// 贴纸中心相对两眼连线向上的偏移，相对于两眼间距
+constexpr float kStickerOffset = 0.3f;
+// 检测结果超过该时长未更新时不再显示，避免画面切换后贴纸停留在旧位置
+constexpr auto kResultTimeout = std::chrono::seconds(1);
 
-float VideoFilter::GetFloat(const std::string& name) { return m_floatValues[name]; }
+glm::vec2 Extrapolate(const glm::vec2& previous, const glm::vec2& latest, float alpha) {
+    return latest + (latest - previous) * alpha;
+}
 
-void VideoFilter::SetInt(const std::string& name, int value) { m_intValues[name] = value; }
+}  // namespace
+
+StickerFilter::StickerFilter() : m_faceDetector(std::make_unique<FaceDetector>()) {
+    m_description.type = VideoFilterType::kSticker;
+    m_description.vertexShaderSource = R"(
+        #version 330 core
+        layout(location = 0) in vec2 a_position;
+        layout(location = 1) in vec2 a_texCoord;
+        out vec2 v_texCoord;
+        uniform mat4 u_modelMatrix;
+        void main() {
+            gl_Position = u_modelMatrix * vec4(a_position, 0.0, 1.0);
+            v_texCoord = a_texCoord;
+        }
+    )";
+    m_description.fragmentShaderSource = R"(
+        #version 330 core
+        in vec2 v_texCoord;
+        out vec4 FragColor;
+        uniform sampler2D u_texture;
+        uniform sampler2D u_stickerTexture;
+        uniform bool u_isSticker;
+        uniform bool u_isKeyPoint;
+        void main() {
+            if (u_isKeyPoint) {
+                FragColor = vec4(0.0, 1.0, 0.0, 1.0);
+            } else if (u_isSticker) {
+                FragColor = texture(u_stickerTexture, v_texCoord);
+            } else {
+                FragColor = texture(u_texture, v_texCoord);
+            }
+        }
+    )";
+}
 
-int VideoFilter::GetInt(const std::string& name) { return m_intValues[name]; }
+StickerFilter::~StickerFilter() {
+    // 先停止检测线程
+    m_faceDetector.reset();
+    if (!m_initialized) return;
 
-void VideoFilter::SetString(const std::string& name, const std::string& value) { m_stringValues[name] = value; }
+    for (auto& buffer : m_pixelBuffers) {
+        if (buffer.fence) glDeleteSync(buffer.fence);
+        if (buffer.pbo) glDeleteBuffers(1, &buffer.pbo);
+    }
+    if (m_readFbo) glDeleteFramebuffers(1, &m_readFbo);
+    if (m_downsampleFbo) glDeleteFramebuffers(1, &m_downsampleFbo);
+    if (m_downsampleTexture) glDeleteTextures(1, &m_downsampleTexture);
+    if (m_stickerTexture) glDeleteTextures(1, &m_stickerTexture);
+    if (m_keyPointVao) glDeleteVertexArrays(1, &m_keyPointVao);
+    if (m_keyPointVbo) glDeleteBuffers(1, &m_keyPointVbo);
+}
 
-std::string VideoFilter::GetString(const std::string& name) { return m_stringValues[name]; }
+void StickerFilter::SetString(const std::string& name, const std::string& value) {
+    if (name == "StickerPath") {
+        std::lock_guard<std::mutex> lock(m_pathMutex);
+        m_stickerPath = value;
+        m_stickerPathChanged = true;
+    } else if (name == "ModelPath") {
+        m_faceDetector->SetModelPath(value);
+    }
+    VideoFilter::SetString(name, value);
+}
 
-bool VideoFilter::Render(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture) {
-    if (!PreRender(frame, outputTexture)) return false;
-    if (!MainRender(frame, outputTexture)) return false;
-    return PostRender();
+void StickerFilter::SetInt(const std::string& name, int value) {
+    if (name == "DetectInterval") {
+        m_detectIntervalMs = std::max(value, 0);
+    } else if (name == "DetectResolution") {
+        m_detectResolution = std::max(value, 0);
+    } else if (name == "ShowKeyPoints") {
+        m_showKeyPoints = value != 0;
+    }
+    VideoFilter::SetInt(name, value);
 }
 
-bool VideoFilter::PreRender(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture) {
-    Initialize();
-    if (!m_initialized) return false;
+void StickerFilter::Initialize() {
+    if (m_initialized) return;
+    VideoFilter::Initialize();
 
-    // Bind FBO and attach output texture
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputTexture, 0);
+    m_uStickerTextureLocation = GetUniformLocation("u_stickerTexture");
+    m_uModelMatrixLocation = GetUniformLocation("u_modelMatrix");
+    m_uIsStickerLocation = GetUniformLocation("u_isSticker");
+    m_uIsKeyPointLocation = GetUniformLocation("u_isKeyPoint");
 
-    // Check if FBO is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "ERROR::FRAMEBUFFER::Framebuffer is not complete!" << std::endl;
-        return false;
+    glGenFramebuffers(1, &m_readFbo);
+    glGenFramebuffers(1, &m_downsampleFbo);
+    for (auto& buffer : m_pixelBuffers) {
+        glGenBuffers(1, &buffer.pbo);
     }
 
-    glViewport(0, 0, frame->width, frame->height);
-    glClearColor(0.0, 0.0, 0.0, 0.0);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(m_shaderProgram);
-    return true;
+    glGenVertexArrays(1, &m_keyPointVao);
+    glGenBuffers(1, &m_keyPointVbo);
+    glBindVertexArray(m_keyPointVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_keyPointVbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
 }
 
-bool VideoFilter::MainRender(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture) {
-    // Bind input texture
+bool StickerFilter::MainRender(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture) {
+    UpdateStickerTexture();
+    UpdateDetectionInput(frame);
+
+    glm::mat4 identity(1.0f);
+    glUniformMatrix4fv(m_uModelMatrixLocation, 1, GL_FALSE, glm::value_ptr(identity));
+    glUniform1i(m_uIsStickerLocation, 0);
+    glUniform1i(m_uIsKeyPointLocation, 0);
+
+    // 先绘制画面
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, frame->textureId);
-    if (m_uTextureLocation == -1) {
-        std::cerr << "ERROR: uniform 'u_texture' not found or inactive!" << std::endl;
-    } else {
-        glUniform1i(m_uTextureLocation, 0);
-    }
-
-    // Render quad
+    glUniform1i(m_uTextureLocation, 0);
     glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glDrawArrays(GL_TRIANGLE_FAN, frame->textureFlipped ? 4 : 0, 4);
+
+    auto faces = PredictFaces(FaceDetector::Clock::now());
+    if (m_stickerTexture && !faces.empty()) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_stickerTexture);
+        glUniform1i(m_uStickerTextureLocation, 1);
+        glUniform1i(m_uIsStickerLocation, 1);
+
+        for (const auto& face : faces) {
+            auto model = CalculateStickerModelMatrix(face.leftEye, face.rightEye, face.roll, face.yaw, face.pitch,
+                                                     frame->width, frame->height);
+            glUniformMatrix4fv(m_uModelMatrixLocation, 1, GL_FALSE, glm::value_ptr(model));
+            // 贴纸图片首行为顶部，使用翻转了纹理坐标的顶点
+            glDrawArrays(GL_TRIANGLE_FAN, 4, 4);
+        }
+
+        glUniform1i(m_uIsStickerLocation, 0);
+        glUniformMatrix4fv(m_uModelMatrixLocation, 1, GL_FALSE, glm::value_ptr(identity));
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glDisable(GL_BLEND);
+    }
     glBindVertexArray(0);
+
+    if (m_showKeyPoints) RenderKeyPoints(faces);
     return true;
 }
 
-bool VideoFilter::PostRender() {
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return true;
+void StickerFilter::UpdateStickerTexture() {
+    std::string stickerPath;
+    {
+        std::lock_guard<std::mutex> lock(m_pathMutex);
+        if (!m_stickerPathChanged) return;
+        m_stickerPathChanged = false;
+        stickerPath = m_stickerPath;
+    }
+
+    if (m_stickerTexture) glDeleteTextures(1, &m_stickerTexture);
+    m_stickerTexture = GLUtils::LoadImageFileToTexture(stickerPath, m_stickerTextureWidth, m_stickerTextureHeight);
 }
 
-void VideoFilter::Initialize() {
-    if (m_initialized) return;
-    m_initialized = true;
+void StickerFilter::UpdateDetectionInput(const std::shared_ptr<IVideoFrame>& frame) {
+    // 已完成的读回提交给检测线程，未完成的留到之后的帧
+    for (auto& buffer : m_pixelBuffers) {
+        if (buffer.fence) FinishReadback(buffer);
+    }
 
-    // Compile and link shaders
-    m_shaderProgram =
-        GLUtils::CompileAndLinkProgram(m_description.vertexShaderSource, m_description.fragmentShaderSource);
+    auto now = FaceDetector::Clock::now();
+    if (now - m_lastReadbackTime < std::chrono::milliseconds(m_detectIntervalMs.load())) return;
 
-    // Define a quad for rendering
-    float vertices[] = {
-        // Positions    // Texture Coords
-        -1.0f, 1.0f,  0.0f, 1.0f,  // Top-left
-        -1.0f, -1.0f, 0.0f, 0.0f,  // Bottom-left
-        1.0f,  -1.0f, 1.0f, 0.0f,  // Bottom-right
-        1.0f,  1.0f,  1.0f, 1.0f   // Top-right
-    };
+    auto& buffer = m_pixelBuffers[m_pixelBufferIndex];
+    // 读回仍在进行时跳过本次，检测频率自动降到 GPU 能跟上的程度
+    if (buffer.fence) return;
 
-    // Setup VAO and VBO
-    glGenVertexArrays(1, &m_vao);
-    glGenBuffers(1, &m_vbo);
+    StartReadback(frame, buffer);
+    m_pixelBufferIndex = (m_pixelBufferIndex + 1) % kPixelBufferCount;
+    m_lastReadbackTime = now;
+}
 
-    glBindVertexArray(m_vao);
+void StickerFilter::StartReadback(const std::shared_ptr<IVideoFrame>& frame, PixelBuffer& buffer) {
+    // 输出纹理绑定在当前帧缓冲上，读取输入纹理使用单独的帧缓冲，结束后恢复原绑定
+    GLint previousReadFbo = 0;
+    GLint previousDrawFbo = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFbo);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFbo);
+
+    int width = 0;
+    int height = 0;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, DownsampleDetectionInput(frame, width, height));
+    size_t size = static_cast<size_t>(width) * height * 4;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    if (buffer.size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        buffer.size = size;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDrawFbo);
+
+    buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    buffer.width = width;
+    buffer.height = height;
+    buffer.bottomUp = !frame->textureFlipped;
+    buffer.timestamp = FaceDetector::Clock::now();
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+GLuint StickerFilter::DownsampleDetectionInput(const std::shared_ptr<IVideoFrame>& frame, int& width, int& height) {
+    width = static_cast<int>(frame->width);
+    height = static_cast<int>(frame->height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frame->textureId, 0);
+
+    // 检测器在较低分辨率下同样可靠，缩小后读回和检测的开销都大幅降低
+    int resolution = m_detectResolution;
+    int shortSide = std::min(width, height);
+    if (resolution <= 0 || shortSide <= resolution) return m_readFbo;
+
+    int targetWidth = std::max(2, (width * resolution / shortSide) & ~1);
+    int targetHeight = std::max(2, (height * resolution / shortSide) & ~1);
+    if (targetWidth != m_downsampleWidth || targetHeight != m_downsampleHeight) {
+        if (m_downsampleTexture) glDeleteTextures(1, &m_downsampleTexture);
+        m_downsampleTexture = GLUtils::GenerateTexture(targetWidth, targetHeight, GL_RGBA, GL_RGBA);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_downsampleFbo);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_downsampleTexture, 0);
+        m_downsampleWidth = targetWidth;
+        m_downsampleHeight = targetHeight;
+    }
 
-    // Position attribute
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    // 检测结果为归一化坐标，缩小后无需换算即可用于原始分辨率
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_downsampleFbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    width = targetWidth;
+    height = targetHeight;
+    return m_downsampleFbo;
+}
 
-    // Texture coord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), reinterpret_cast<void*>(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+bool StickerFilter::FinishReadback(PixelBuffer& buffer) {
+    // 不等待，GPU 尚未完成时直接返回
+    GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(buffer.fence);
+    buffer.fence = nullptr;
+    if (status == GL_WAIT_FAILED) return false;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    auto* mapped = static_cast<const uint8_t*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(buffer.size), GL_MAP_READ_BIT));
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return false;
+    }
 
-    glBindVertexArray(0);
+    // 检测器要求首行为画面顶部
+    size_t stride = static_cast<size_t>(buffer.width) * 4;
+    std::vector<uint8_t> rgbaData(buffer.size);
+    if (buffer.bottomUp) {
+        for (int row = 0; row < buffer.height; ++row) {
+            std::memcpy(rgbaData.data() + row * stride, mapped + (buffer.height - 1 - row) * stride, stride);
+        }
+    } else {
+        std::memcpy(rgbaData.data(), mapped, buffer.size);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-    m_uTextureLocation = glGetUniformLocation(m_shaderProgram, "u_texture");
+    m_faceDetector->SubmitFrame(std::move(rgbaData), buffer.width, buffer.height, buffer.timestamp);
+    return true;
 }
 
-int VideoFilter::GetUniformLocation(const std::string& name) {
-    auto [it, inserted] = m_uniformLocationCache.try_emplace(name, glGetUniformLocation(m_shaderProgram, name.c_str()));
-    if (it->second == -1) std::cerr << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
-    return it->second;
+std::vector<FaceDetector::Face> StickerFilter::PredictFaces(FaceDetector::Clock::time_point now) {
+    FaceDetector::Result previous;
+    FaceDetector::Result latest;
+    if (!m_faceDetector->GetResults(previous, latest)) return {};
+    if (now - latest.timestamp > kResultTimeout) return {};
+
+    // 按最近两次检测间的运动线性外推，最多外推一个检测间隔，检测结果之间的贴纸不会停顿跳变
+    float interval = std::chrono::duration<float>(latest.timestamp - previous.timestamp).count();
+    float elapsed = std::chrono::duration<float>(now - latest.timestamp).count();
+    float alpha = interval > 0.0f ? std::min(elapsed / interval, 1.0f) : 0.0f;
+    if (alpha <= 0.0f) return latest.faces;
+
+    std::vector<FaceDetector::Face> faces = latest.faces;
+    for (auto& face : faces) {
+        auto it = std::find_if(previous.faces.begin(), previous.faces.end(),
+                               [&face](const FaceDetector::Face& other) { return other.trackId == face.trackId; });
+        if (it == previous.faces.end()) continue;
+
+        face.leftEye = Extrapolate(it->leftEye, face.leftEye, alpha);
+        face.rightEye = Extrapolate(it->rightEye, face.rightEye, alpha);
+        face.roll += (face.roll - it->roll) * alpha;
+        face.yaw += (face.yaw - it->yaw) * alpha;
+        face.pitch += (face.pitch - it->pitch) * alpha;
+        if (face.keyPoints.size() == it->keyPoints.size()) {
+            for (size_t i = 0; i < face.keyPoints.size(); ++i) {
+                face.keyPoints[i] = Extrapolate(it->keyPoints[i], face.keyPoints[i], alpha);
+            }
+        }
+    }
+    return faces;
 }
 
-VideoFilter* VideoFilter::Create(VideoFilterType type) {
-    switch (type) {
-        case VideoFilterType::kFlipVertical:
-            return new FlipVerticalFilter();
-        case VideoFilterType::kGray:
-            return new GrayFilter();
-        case VideoFilterType::kInvert:
-            return new InvertFilter();
-        case VideoFilterType::kSticker:
-            return new StickerFilter();
-        default:
-            break;
-    }
+glm::mat4 StickerFilter::CalculateStickerModelMatrix(const glm::vec2& leftEye, const glm::vec2& rightEye, float roll,
+                                                     float yaw, float pitch, int width, int height) {
+    // 在像素坐标（原点左下角，y 向上）中计算，再映射到标准化设备坐标
+    glm::vec2 left(leftEye.x * width, (1.0f - leftEye.y) * height);
+    glm::vec2 right(rightEye.x * width, (1.0f - rightEye.y) * height);
+    glm::vec2 delta = right - left;
+    float eyeDistance = glm::length(delta);
+    // 双眼连线已包含翻滚角，只在两眼重合时使用检测给出的角度
+    float angle = eyeDistance > 0.0f ? std::atan2(delta.y, delta.x) : -roll * kDegreesToRadians;
+
+    // 侧脸和俯仰时人脸在画面中的投影变窄或变矮
+    float halfWidth = eyeDistance * kStickerScale / std::max(std::cos(yaw * kDegreesToRadians), 0.5f);
+    float aspect = m_stickerTextureWidth > 0 ? static_cast<float>(m_stickerTextureHeight) / m_stickerTextureWidth : 1.0f;
+    float halfHeight = halfWidth * aspect * std::max(std::cos(pitch * kDegreesToRadians), 0.5f);
+
+    glm::vec2 up(-std::sin(angle), std::cos(angle));
+    glm::vec2 center = (left + right) * 0.5f + up * (eyeDistance * kStickerOffset);
+
+    glm::mat4 model(1.0f);
+    model = glm::translate(model, glm::vec3(-1.0f, -1.0f, 0.0f));
+    model = glm::scale(model, glm::vec3(2.0f / width, 2.0f / height, 1.0f));
+    model = glm::translate(model, glm::vec3(center, 0.0f));
+    model = glm::rotate(model, angle, glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::scale(model, glm::vec3(halfWidth, halfHeight, 1.0f));
+    return model;
+}
 
-    return nullptr;
+void StickerFilter::RenderKeyPoints(const std::vector<FaceDetector::Face>& faces) {
+    std::vector<float> points;
+    for (const auto& face : faces) {
+        for (const auto& point : face.keyPoints) {
+            points.push_back(point.x * 2.0f - 1.0f);
+            points.push_back(1.0f - point.y * 2.0f);
+        }
+    }
+    if (points.empty()) return;
+
+    glUniform1i(m_uIsKeyPointLocation, 1);
+    glBindVertexArray(m_keyPointVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_keyPointVbo);
+    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(float), points.data(), GL_STREAM_DRAW);
+    glPointSize(3.0f);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(points.size() / 2));
+    glBindVertexArray(0);
+    glUniform1i(m_uIsKeyPointLocation, 0);
 }
 
-}  // namespace av
\ No newline at end of file
+}  // namespace av
@@ -4,42 +4,65 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "FaceDetector.h"
 #include "VideoFilter.h"
-#include "inspireface.h"
 
 namespace av {
 
+// 贴纸滤镜：在检测到的人脸上绘制贴纸
+// 检测在 FaceDetector 线程中进行，渲染线程按设定频率异步读回画面提交检测，
+// 绘制时只读取最近的结果并按人脸运动推算当前位置，不等待检测
+//
+// 参数：
+//   StickerPath     贴纸图片路径
+//   ModelPath       InspireFace 模型路径
+//   DetectInterval  两次检测的最小间隔，单位毫秒，默认 100
+//   DetectResolution 检测图像短边的像素数，画面更大时先在 GPU 上缩小，0 表示使用原始分辨率，默认 480
+//   ShowKeyPoints   非 0 时绘制人脸关键点
 class StickerFilter : public VideoFilter {
 public:
     StickerFilter();
     ~StickerFilter() override;
     void SetString(const std::string& name, const std::string& value) override;
+    void SetInt(const std::string& name, int value) override;
     bool MainRender(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture) override;
     void Initialize() override;
 
 private:
-    bool LoadFaceDetectionModel(const std::string& modelPath);
-    bool DetectFaces(std::shared_ptr<IVideoFrame> frame);
+    // 像素读回缓冲区，读回完成前不阻塞渲染
+    struct PixelBuffer {
+        GLuint pbo{0};
+        GLsync fence{nullptr};
+        size_t size{0};
+        int width{0};
+        int height{0};
+        bool bottomUp{false};  // 数据首行为画面底部
+        FaceDetector::Clock::time_point timestamp;
+    };
+
+    void UpdateStickerTexture();
+    // 按检测间隔发起读回，并把已完成的读回提交给检测线程
+    void UpdateDetectionInput(const std::shared_ptr<IVideoFrame>& frame);
+    void StartReadback(const std::shared_ptr<IVideoFrame>& frame, PixelBuffer& buffer);
+    // 按检测分辨率缩小输入纹理，返回读取用的帧缓冲，不需要缩小时返回输入纹理所在的帧缓冲
+    GLuint DownsampleDetectionInput(const std::shared_ptr<IVideoFrame>& frame, int& width, int& height);
+    bool FinishReadback(PixelBuffer& buffer);
+    // 根据最近两次检测结果推算当前时刻的人脸位置
+    std::vector<FaceDetector::Face> PredictFaces(FaceDetector::Clock::time_point now);
     glm::mat4 CalculateStickerModelMatrix(const glm::vec2& leftEye, const glm::vec2& rightEye, float roll, float yaw,
-                                          float pitch);
+                                          float pitch, int width, int height);
+    void RenderKeyPoints(const std::vector<FaceDetector::Face>& faces);
 
 private:
-    struct DetectedFaceInfo {
-        const glm::vec2 leftEye;
-        const glm::vec2 rightEye;
-        float roll;
-        float yaw;
-        float pitch;
-
-        std::vector<glm::vec2> keyPoints;
-
-        DetectedFaceInfo(const glm::vec2& leftEye, const glm::vec2& rightEye, float roll, float yaw, float pitch,
-                         const std::vector<glm::vec2>& points)
-            : leftEye(leftEye), rightEye(rightEye), roll(roll), yaw(yaw), pitch(pitch), keyPoints(points) {}
-    };
-
+    std::mutex m_pathMutex;
     std::string m_stickerPath;
-    std::string m_modelPath;
+    bool m_stickerPathChanged{false};
+
     unsigned m_stickerTexture{0};
     int m_stickerTextureWidth{0};
     int m_stickerTextureHeight{0};
@@ -48,9 +71,25 @@ private:
     int m_uIsStickerLocation{0};
     int m_uIsKeyPointLocation{0};
 
+    std::atomic<int> m_detectIntervalMs{100};
+    std::atomic<int> m_detectResolution{480};
+    std::atomic<bool> m_showKeyPoints{false};
+
     // 人脸检测相关
-    HFSession m_session{0};
-    std::vector<DetectedFaceInfo> m_detectedFaces;
+    std::unique_ptr<FaceDetector> m_faceDetector;
+    GLuint m_readFbo{0};
+    // 缩小后的检测图像
+    GLuint m_downsampleFbo{0};
+    GLuint m_downsampleTexture{0};
+    int m_downsampleWidth{0};
+    int m_downsampleHeight{0};
+    static constexpr size_t kPixelBufferCount = 2;
+    std::array<PixelBuffer, kPixelBufferCount> m_pixelBuffers;
+    size_t m_pixelBufferIndex{0};
+    FaceDetector::Clock::time_point m_lastReadbackTime;
+
+    GLuint m_keyPointVao{0};
+    GLuint m_keyPointVbo{0};
 };
 
-}  // namespace av
\ No newline at end of file
+}  // namespace av
@@ -1,6 +1,7 @@
 #include "VideoFilter.h"
 
 #include "FlipVerticalFilter.h"
+#include "FusedVideoFilter.h"
 #include "GrayFilter.h"
 #include "InvertFilter.h"
 #include "StickerFilter.h"
@@ -63,9 +64,9 @@ bool VideoFilter::MainRender(std::shared_ptr<IVideoFrame> frame, unsigned int ou
         glUniform1i(m_uTextureLocation, 0);
     }
 
-    // Render quad
+    // Render quad，行序相反的纹理使用翻转了纹理坐标的后四个顶点
     glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glDrawArrays(GL_TRIANGLE_FAN, frame->textureFlipped ? 4 : 0, 4);
     glBindVertexArray(0);
     return true;
 }
@@ -78,6 +79,7 @@ bool VideoFilter::PostRender() {
 void VideoFilter::Initialize() {
     if (m_initialized) return;
     m_initialized = true;
+    initializeOpenGLFunctions();
 
     // Compile and link shaders
     m_shaderProgram =
@@ -89,7 +91,12 @@ void VideoFilter::Initialize() {
         -1.0f, 1.0f,  0.0f, 1.0f,  // Top-left
         -1.0f, -1.0f, 0.0f, 0.0f,  // Bottom-left
         1.0f,  -1.0f, 1.0f, 0.0f,  // Bottom-right
-        1.0f,  1.0f,  1.0f, 1.0f   // Top-right
+        1.0f,  1.0f,  1.0f, 1.0f,  // Top-right
+        // 纹理坐标垂直翻转
+        -1.0f, 1.0f,  0.0f, 0.0f,  // Top-left
+        -1.0f, -1.0f, 0.0f, 1.0f,  // Bottom-left
+        1.0f,  -1.0f, 1.0f, 1.0f,  // Bottom-right
+        1.0f,  1.0f,  1.0f, 0.0f   // Top-right
     };
 
     // Setup VAO and VBO
@@ -120,6 +127,25 @@ int VideoFilter::GetUniformLocation(const std::string& name) {
     return it->second;
 }
 
+void VideoFilter::PrewarmPrograms() {
+    // 贴纸滤镜初始化依赖外部资源，不参与预热
+    const VideoFilterType types[] = {VideoFilterType::kFlipVertical, VideoFilterType::kGray, VideoFilterType::kInvert};
+
+    std::vector<std::shared_ptr<VideoFilter>> filters;
+    for (auto type : types) {
+        auto filter = std::shared_ptr<VideoFilter>(Create(type));
+        if (!filter) continue;
+        filter->Initialize();
+        filters.push_back(filter);
+    }
+    for (auto& first : filters) {
+        for (auto& second : filters) {
+            if (first == second || !first->IsFusable() || !second->IsFusable()) continue;
+            FusedVideoFilter({first, second}).Initialize();
+        }
+    }
+}
+
 VideoFilter* VideoFilter::Create(VideoFilterType type) {
     switch (type) {
         case VideoFilterType::kFlipVertical:
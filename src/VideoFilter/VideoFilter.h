@@ -30,6 +30,14 @@ public:
 
     bool Render(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture);
     static VideoFilter* Create(VideoFilterType type);
+    // 需要当前上下文，编译内置滤镜及其两两合并的着色器并写入程序二进制缓存
+    // 播放中途添加滤镜时只需从缓存加载，避免编译造成卡顿
+    static void PrewarmPrograms();
+
+    // 只依赖当前像素的滤镜提供可合并的着色器片段，相邻的此类滤镜由 FusedVideoFilter 合并为一次绘制
+    bool IsFusable() const { return m_description.fusedTexCoordSnippet || m_description.fusedColorSnippet; }
+    const char* GetFusedTexCoordSnippet() const { return m_description.fusedTexCoordSnippet; }
+    const char* GetFusedColorSnippet() const { return m_description.fusedColorSnippet; }
 
 protected:
     // 初始化，包括编译着色器，创建 VAO VBO，设置纹理等信息
@@ -48,6 +56,9 @@ protected:
         VideoFilterType type{VideoFilterType::kNone};
         const char* vertexShaderSource{nullptr};
         const char* fragmentShaderSource{nullptr};
+        // 可合并片段：texCoord 变换在采样前执行，color 变换在采样后执行
+        const char* fusedTexCoordSnippet{nullptr};  // 修改 vec2 texCoord
+        const char* fusedColorSnippet{nullptr};     // 修改 vec4 color
     };
 
 protected:
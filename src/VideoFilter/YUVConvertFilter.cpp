@@ -0,0 +1,145 @@
+#include "YUVConvertFilter.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+namespace av {
+
+YUVConvertFilter::YUVConvertFilter() {
+    m_description.type = VideoFilterType::kNone;
+    // 解码数据首行为图像顶部，纹理坐标原点在底部，因此在此处顺带完成垂直翻转
+    m_description.vertexShaderSource = R"(
+        #version 330 core
+        layout(location = 0) in vec2 a_position;
+        layout(location = 1) in vec2 a_texCoord;
+        out vec2 v_texCoord;
+        void main() {
+            gl_Position = vec4(a_position, 0.0, 1.0);
+            v_texCoord = vec2(a_texCoord.x, 1.0 - a_texCoord.y);
+        }
+    )";
+    m_description.fragmentShaderSource = R"(
+        #version 330 core
+        in vec2 v_texCoord;
+        out vec4 FragColor;
+        uniform sampler2D u_textureY;
+        uniform sampler2D u_textureU;
+        uniform sampler2D u_textureV;
+        uniform int u_isNV12;
+        uniform mat3 u_colorMatrix;
+        uniform vec3 u_colorOffset;
+        void main() {
+            float y = texture(u_textureY, v_texCoord).r;
+            vec2 uv;
+            if (u_isNV12 == 1) {
+                uv = texture(u_textureU, v_texCoord).rg;
+            } else {
+                uv = vec2(texture(u_textureU, v_texCoord).r, texture(u_textureV, v_texCoord).r);
+            }
+            vec3 rgb = u_colorMatrix * (vec3(y, uv) - u_colorOffset);
+            FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+        }
+    )";
+}
+
+YUVConvertFilter::~YUVConvertFilter() {
+    for (auto& plane : m_planes) {
+        if (plane.id) glDeleteTextures(1, &plane.id);
+    }
+}
+
+void YUVConvertFilter::Initialize() {
+    if (m_initialized) return;
+    initializeOpenGLFunctions();
+    VideoFilter::Initialize();
+}
+
+void YUVConvertFilter::UploadPlane(int index, const uint8_t* data, int linesize, int width, int height,
+                                   int bytesPerPixel) {
+    auto& plane = m_planes[index];
+    GLenum format = bytesPerPixel == 2 ? GL_RG : GL_RED;
+    GLenum internalFormat = bytesPerPixel == 2 ? GL_RG8 : GL_R8;
+
+    if (!plane.id) {
+        glGenTextures(1, &plane.id);
+        glBindTexture(GL_TEXTURE_2D, plane.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, plane.id);
+    }
+
+    // linesize 可能大于有效宽度，通过 GL_UNPACK_ROW_LENGTH 跳过行尾填充，避免 CPU 端重新打包
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, linesize / bytesPerPixel);
+    if (plane.width != width || plane.height != height || plane.bytesPerPixel != bytesPerPixel) {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        plane.width = width;
+        plane.height = height;
+        plane.bytesPerPixel = bytesPerPixel;
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void YUVConvertFilter::UpdateColorMatrix(int colorSpace, int colorRange, bool isFullRangeFormat) {
+    bool isBT709 = colorSpace == AVCOL_SPC_BT709;
+    bool isFullRange = isFullRangeFormat || colorRange == AVCOL_RANGE_JPEG;
+
+    // 列主序：三列依次为 Y、U、V 的系数
+    static const float kBT601Limited[9] = {1.164f, 1.164f, 1.164f, 0.0f, -0.392f, 2.017f, 1.596f, -0.813f, 0.0f};
+    static const float kBT601Full[9] = {1.0f, 1.0f, 1.0f, 0.0f, -0.344f, 1.772f, 1.402f, -0.714f, 0.0f};
+    static const float kBT709Limited[9] = {1.164f, 1.164f, 1.164f, 0.0f, -0.213f, 2.112f, 1.793f, -0.533f, 0.0f};
+    static const float kBT709Full[9] = {1.0f, 1.0f, 1.0f, 0.0f, -0.187f, 1.856f, 1.575f, -0.468f, 0.0f};
+
+    const float* matrix = isBT709 ? (isFullRange ? kBT709Full : kBT709Limited)
+                                  : (isFullRange ? kBT601Full : kBT601Limited);
+    glUniformMatrix3fv(GetUniformLocation("u_colorMatrix"), 1, GL_FALSE, matrix);
+    glUniform3f(GetUniformLocation("u_colorOffset"), isFullRange ? 0.0f : 16.0f / 255.0f, 0.5f, 0.5f);
+}
+
+bool YUVConvertFilter::MainRender(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture) {
+    auto avFrame = frame->avFrame;
+    if (!avFrame) return false;
+
+    int chromaWidth = (frame->width + 1) / 2;
+    int chromaHeight = (frame->height + 1) / 2;
+    bool isNV12 = frame->format == VideoPixelFormat::kNV12;
+
+    UploadPlane(0, avFrame->data[0], avFrame->linesize[0], frame->width, frame->height, 1);
+    if (isNV12) {
+        UploadPlane(1, avFrame->data[1], avFrame->linesize[1], chromaWidth, chromaHeight, 2);
+    } else {
+        UploadPlane(1, avFrame->data[1], avFrame->linesize[1], chromaWidth, chromaHeight, 1);
+        UploadPlane(2, avFrame->data[2], avFrame->linesize[2], chromaWidth, chromaHeight, 1);
+    }
+
+    const char* samplerNames[3] = {"u_textureY", "u_textureU", "u_textureV"};
+    int planeCount = isNV12 ? 2 : 3;
+    for (int i = 0; i < planeCount; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, m_planes[i].id);
+        glUniform1i(GetUniformLocation(samplerNames[i]), i);
+    }
+    glUniform1i(GetUniformLocation("u_isNV12"), isNV12 ? 1 : 0);
+    UpdateColorMatrix(avFrame->colorspace, avFrame->color_range, avFrame->format == AV_PIX_FMT_YUVJ420P);
+
+    glBindVertexArray(m_vao);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glBindVertexArray(0);
+
+    for (int i = planeCount - 1; i > 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    return true;
+}
+
+}  // namespace av
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "VideoFilter.h"
+
+namespace av {
+// YUV 转 RGBA 滤镜，将 YUV420P/NV12 各平面分别上传为纹理，在着色器中完成颜色转换和垂直翻转
+class YUVConvertFilter : public VideoFilter {
+public:
+    YUVConvertFilter();
+    ~YUVConvertFilter() override;
+
+protected:
+    void Initialize() override;
+    bool MainRender(std::shared_ptr<IVideoFrame> frame, unsigned int outputTexture) override;
+
+private:
+    // 上传单个平面，尺寸不变时复用已有纹理存储
+    void UploadPlane(int index, const uint8_t* data, int linesize, int width, int height, int bytesPerPixel);
+    // 根据色彩空间和色彩范围设置转换矩阵
+    void UpdateColorMatrix(int colorSpace, int colorRange, bool isFullRangeFormat);
+
+private:
+    struct PlaneTexture {
+        unsigned int id{0};
+        int width{0};
+        int height{0};
+        int bytesPerPixel{0};
+    };
+    PlaneTexture m_planes[3];
+};
+
+}  // namespace av
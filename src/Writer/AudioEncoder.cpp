@@ -66,43 +66,35 @@ bool AudioEncoder::Configure(FileWriterParameters& parameters, int flags) {
 
 void AudioEncoder::NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
     if (!audioSamples) return;
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_audioSamplesQueue.push_back(audioSamples);
-    m_cond.notify_all();
+    if (audioSamples->flags & static_cast<int>(AVFrameFlag::kEOS)) {
+        m_endOfStream = true;
+    } else {
+        // 编码跟不上时等待，不丢弃数据
+        m_audioSamplesQueue.Push(std::move(audioSamples), [this]() { return m_abort.load(); });
+    }
+    m_notifier.Notify();
 }
 
 void AudioEncoder::ThreadLoop() {
-    for (;;) {
-        {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            m_cond.wait(lock, [this] { return m_abort || !m_audioSamplesQueue.empty(); });
-            if (m_abort) break;
-        }
-
+    while (!m_abort) {
         std::shared_ptr<IAudioSamples> audioSamples;
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (m_audioSamplesQueue.empty()) return;
-
-            audioSamples = m_audioSamplesQueue.front();
-            m_audioSamplesQueue.pop_front();
-        }
-
-        if (audioSamples) {
-            auto isEndOfStream = audioSamples->flags & static_cast<int>(AVFrameFlag::kEOS);
-            isEndOfStream ? EncodeAudioSamples(nullptr) : PrepareEncodeAudioSamples(audioSamples);
+        if (m_audioSamplesQueue.TryPop(audioSamples)) {
+            PrepareEncodeAudioSamples(audioSamples);
+        } else if (m_endOfStream.exchange(false)) {
+            // 队列中的数据全部编码后再冲刷编码器
+            EncodeAudioSamples(nullptr);
+        } else {
+            m_notifier.Wait();
         }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_audioSamplesQueue.clear();
-    }
+    m_audioSamplesQueue.Clear();
 }
 
 void AudioEncoder::StopThread() {
     m_abort = true;
-    m_cond.notify_all();
+    m_notifier.Notify();
+    m_audioSamplesQueue.WakeProducer();
     if (m_thread.joinable()) m_thread.join();
 }
 
@@ -136,13 +128,18 @@ void AudioEncoder::PrepareEncodeAudioSamples(std::shared_ptr<IAudioSamples> audi
 }
 
 void AudioEncoder::EncodeAudioSamples(const AVFrame* avFrame) {
+    // 未配置（例如直接复制模式）时不会有数据需要冲刷
+    if (!m_encodeCtx || !m_avPacket) return;
     int ret = avcodec_send_frame(m_encodeCtx, avFrame);
     if (ret < 0) return;
 
     while (ret >= 0) {
         ret = avcodec_receive_packet(m_encodeCtx, m_avPacket);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        if (ret == AVERROR(EAGAIN)) {
             return;
+        } else if (ret == AVERROR_EOF) {
+            // 冲刷完成，继续向下通知结束
+            break;
         } else if (ret < 0) {
             std::cout << "Error encoding audio frame: " << ret << std::endl;
             return;
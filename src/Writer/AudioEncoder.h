@@ -1,12 +1,12 @@
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
-#include <list>
 #include <memory>
 #include <mutex>
 #include <thread>
 
+#include "Core/SPSCQueue.h"
+#include "Core/SyncNotifier.h"
 #include "Interface/IAudioEncoder.h"
 
 extern "C" {
@@ -38,13 +38,14 @@ private:
     Listener* m_listener{nullptr};
     std::mutex m_listenerMutex;
 
-    // AVPacket 队列
-    std::list<std::shared_ptr<IAudioSamples>> m_audioSamplesQueue;
-    std::condition_variable m_cond;
-    std::mutex m_mutex;
+    // 音频数据队列，生产者为音频处理线程，队列满时等待编码线程；结束标记可能来自其它线程，单独用标志位传递
+    static constexpr size_t kSamplesQueueCapacity = 64;
+    SPSCQueue<std::shared_ptr<IAudioSamples>> m_audioSamplesQueue{kSamplesQueueCapacity};
+    std::atomic<bool> m_endOfStream{false};
+    SyncNotifier m_notifier;
 
-    std::thread m_thread;
     std::atomic<bool> m_abort{false};
+    std::thread m_thread;
 
     // 编码 & 重采样
     AVCodecContext* m_encodeCtx{nullptr};
@@ -1,14 +1,16 @@
 #include "FileWriter.h"
 
+#include <algorithm>
 #include <iostream>
 
+#include "SoftwareVideoEncoder.h"
+
 namespace av {
 
-IFileWriter* IFileWriter::Create(GLContext& glContext) { return new FileWriter(glContext); }
+IFileWriter* IFileWriter::CreateSoftware() { return new FileWriter(std::make_shared<SoftwareVideoEncoder>()); }
 
-FileWriter::FileWriter(GLContext& glContext) {
+FileWriter::FileWriter(std::shared_ptr<IVideoEncoder> videoEncoder) : m_videoEncoder(std::move(videoEncoder)) {
     m_audioEncoder = std::make_shared<AudioEncoder>();
-    m_videoEncoder = std::make_shared<VideoEncoder>(glContext);
     m_muxer = std::make_shared<Muxer>();
 
     m_audioEncoder->SetListener(this);
@@ -22,6 +24,11 @@ FileWriter::~FileWriter() {
     m_muxer = nullptr;
 }
 
+void FileWriter::SetListener(IFileWriter::Listener* listener) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    m_listener = listener;
+}
+
 bool FileWriter::StartWriter(const std::string& outputFilePath, FileWriterParameters& parameters, int flags) {
     auto succ1 = m_audioEncoder->Configure(parameters, flags);
     auto succ2 = m_videoEncoder->Configure(parameters, flags);
@@ -35,26 +42,111 @@ void FileWriter::StopWriter() {
     NotifyVideoFinished();
 }
 
+bool FileWriter::StartRemux(const std::string& outputFilePath, const AVStream* audioStream,
+                            const AVStream* videoStream) {
+    if (!m_muxer->ConfigureStreamCopy(outputFilePath, audioStream, videoStream)) return false;
+
+    std::lock_guard<std::mutex> lock(m_remuxMutex);
+    m_hasRemuxVideo = videoStream != nullptr;
+    m_isWaitingKeyframe = true;
+    m_remuxOffset = 0;
+    m_remuxEndTime = 0;
+    m_isRemuxing = true;
+    return true;
+}
+
+void FileWriter::NotifyAudioPacket(std::shared_ptr<IAVPacket> packet) {
+    if (!m_isRemuxing || !packet) return;
+
+    std::lock_guard<std::mutex> lock(m_remuxMutex);
+    if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
+        // 有视频时以视频关键帧为起点，刷新由视频包处理
+        if (!m_hasRemuxVideo) m_isWaitingKeyframe = true;
+        return;
+    }
+    if (!packet->avPacket) return;
+    // 视频还没有开始时丢弃音频，保证文件开头音画对齐
+    if (m_hasRemuxVideo && m_isWaitingKeyframe) return;
+    WriteRemuxPacket(packet, false);
+}
+
+void FileWriter::NotifyVideoPacket(std::shared_ptr<IAVPacket> packet) {
+    if (!m_isRemuxing || !packet) return;
+
+    std::lock_guard<std::mutex> lock(m_remuxMutex);
+    if (packet->flags & static_cast<int>(AVFrameFlag::kFlush)) {
+        m_isWaitingKeyframe = true;
+        return;
+    }
+    if (!packet->avPacket) return;
+    if (m_isWaitingKeyframe && !(packet->avPacket->flags & AV_PKT_FLAG_KEY)) return;
+    WriteRemuxPacket(packet, true);
+}
+
+void FileWriter::WriteRemuxPacket(std::shared_ptr<IAVPacket> packet, bool isVideo) {
+    const AVRational microseconds{1, AV_TIME_BASE};
+    AVPacket* avPacket = packet->avPacket;
+    int64_t dts = avPacket->dts != AV_NOPTS_VALUE ? avPacket->dts : avPacket->pts;
+    if (dts == AV_NOPTS_VALUE || packet->timeBase.den == 0) return;
+
+    if (m_isWaitingKeyframe) {
+        // 起点（包括跳转后的新起点）接在已写入数据之后，输出时间保持连续
+        m_remuxOffset = av_rescale_q(dts, packet->timeBase, microseconds) - m_remuxEndTime;
+        m_isWaitingKeyframe = false;
+    }
+
+    int64_t offset = av_rescale_q(m_remuxOffset, microseconds, packet->timeBase);
+    if (avPacket->pts != AV_NOPTS_VALUE) avPacket->pts -= offset;
+    if (avPacket->dts != AV_NOPTS_VALUE) avPacket->dts -= offset;
+    // 早于起点的音频包
+    if (dts - offset < 0) return;
+
+    int64_t endPts = (avPacket->pts != AV_NOPTS_VALUE ? avPacket->pts : dts - offset) + avPacket->duration;
+    m_remuxEndTime = std::max(m_remuxEndTime, av_rescale_q(endPts, packet->timeBase, microseconds));
+
+    if (isVideo) {
+        m_muxer->NotifyVideoPacket(packet);
+    } else {
+        m_muxer->NotifyAudioPacket(packet);
+    }
+}
+
 void FileWriter::NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) {
+    // 直接复制模式下数据来自源数据包
+    if (m_isRemuxing) return;
     if (m_audioEncoder) m_audioEncoder->NotifyAudioSamples(audioSamples);
 }
 
 void FileWriter::NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    if (m_isRemuxing) return;
     if (m_videoEncoder) m_videoEncoder->NotifyVideoFrame(videoFrame);
 }
 
 void FileWriter::NotifyAudioFinished() {
+    if (m_isRemuxing) {
+        // 没有经过编码器，直接结束封装
+        OnAudioEncoderNotifyFinished();
+        return;
+    }
     auto audioSamples = std::make_shared<IAudioSamples>();
     audioSamples->flags |= static_cast<int>(AVFrameFlag::kEOS);
     NotifyAudioSamples(audioSamples);
 }
 
 void FileWriter::NotifyVideoFinished() {
+    if (m_isRemuxing) {
+        OnVideoEncoderNotifyFinished();
+        return;
+    }
     auto videoFrame = std::make_shared<IVideoFrame>();
     videoFrame->flags |= static_cast<int>(AVFrameFlag::kEOS);
     NotifyVideoFrame(videoFrame);
 }
 
+VideoReadbackStats FileWriter::GetVideoReadbackStats() {
+    return m_videoEncoder ? m_videoEncoder->GetReadbackStats() : VideoReadbackStats{};
+}
+
 // 继承自 AudioEncoder::Listener
 void FileWriter::OnAudioEncoderNotifyPacket(std::shared_ptr<IAVPacket> packet) {
     if (m_muxer) m_muxer->NotifyAudioPacket(packet);
@@ -62,15 +154,34 @@ void FileWriter::OnAudioEncoderNotifyPacket(std::shared_ptr<IAVPacket> packet) {
 
 void FileWriter::OnAudioEncoderNotifyFinished() {
     if (m_muxer) m_muxer->NotifyAudioFinished();
+    {
+        std::lock_guard<std::mutex> lock(m_listenerMutex);
+        m_audioFinished = true;
+    }
+    NotifyFinishedIfDone();
 }
 
-// 继承自 VideoEncoder::Listener
+// 继承自 IVideoEncoder::Listener
 void FileWriter::OnVideoEncoderNotifyPacket(std::shared_ptr<IAVPacket> packet) {
     if (m_muxer) m_muxer->NotifyVideoPacket(packet);
 }
 
 void FileWriter::OnVideoEncoderNotifyFinished() {
     if (m_muxer) m_muxer->NotifyVideoFinished();
+    {
+        std::lock_guard<std::mutex> lock(m_listenerMutex);
+        m_videoFinished = true;
+    }
+    NotifyFinishedIfDone();
+}
+
+void FileWriter::NotifyFinishedIfDone() {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    if (m_audioFinished && m_videoFinished && m_listener) {
+        m_listener->OnFileWriterNotifyFinished();
+        // 只通知一次
+        m_listener = nullptr;
+    }
 }
 
 }  // namespace av
\ No newline at end of file
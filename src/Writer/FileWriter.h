@@ -2,38 +2,69 @@
 
 #include "AudioEncoder.h"
 #include "Interface/IFileWriter.h"
+#include "Interface/IVideoEncoder.h"
 #include "Muxer.h"
-#include "VideoEncoder.h"
+
+#include <atomic>
+#include <mutex>
 
 namespace av {
 
-class FileWriter : public IFileWriter, public AudioEncoder::Listener, VideoEncoder::Listener {
+class FileWriter : public IFileWriter, public AudioEncoder::Listener, IVideoEncoder::Listener {
 public:
-    explicit FileWriter(GLContext& glContext);
+    explicit FileWriter(std::shared_ptr<IVideoEncoder> videoEncoder);
     ~FileWriter() override;
 
+    void SetListener(IFileWriter::Listener* listener) override;
+
     bool StartWriter(const std::string& outputFilePath, FileWriterParameters& parameters, int flags) override;
     void StopWriter() override;
 
+    bool StartRemux(const std::string& outputFilePath, const AVStream* audioStream,
+                    const AVStream* videoStream) override;
+    void NotifyAudioPacket(std::shared_ptr<IAVPacket> packet) override;
+    void NotifyVideoPacket(std::shared_ptr<IAVPacket> packet) override;
+
     void NotifyAudioSamples(std::shared_ptr<IAudioSamples> audioSamples) override;
     void NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) override;
 
     void NotifyAudioFinished() override;
     void NotifyVideoFinished() override;
 
+    VideoReadbackStats GetVideoReadbackStats() override;
+
 private:
     // 继承自 AudioEncoder::Listener
     void OnAudioEncoderNotifyPacket(std::shared_ptr<IAVPacket>) override;
     void OnAudioEncoderNotifyFinished() override;
 
-    // 继承自 VideoEncoder::Listener
+    // 继承自 IVideoEncoder::Listener
     void OnVideoEncoderNotifyPacket(std::shared_ptr<IAVPacket>) override;
     void OnVideoEncoderNotifyFinished() override;
 
+    // 两路编码器都结束后通知监听者
+    void NotifyFinishedIfDone();
+
+    // 直接复制模式：调整时间戳后写入封装器，调用方需持有 m_remuxMutex
+    void WriteRemuxPacket(std::shared_ptr<IAVPacket> packet, bool isVideo);
+
 private:
     std::shared_ptr<AudioEncoder> m_audioEncoder;
-    std::shared_ptr<VideoEncoder> m_videoEncoder;
+    std::shared_ptr<IVideoEncoder> m_videoEncoder;
     std::shared_ptr<Muxer> m_muxer;
+
+    IFileWriter::Listener* m_listener{nullptr};
+    std::mutex m_listenerMutex;
+    bool m_audioFinished{false};
+    bool m_videoFinished{false};
+
+    // 直接复制模式
+    std::atomic<bool> m_isRemuxing{false};
+    std::mutex m_remuxMutex;
+    bool m_hasRemuxVideo{false};
+    bool m_isWaitingKeyframe{true};  // 从关键帧开始写入，跳转后重新等待
+    int64_t m_remuxOffset{0};        // 源时间减去输出时间，微秒
+    int64_t m_remuxEndTime{0};       // 已写入数据的结束时间，微秒
 };
 
-}
\ No newline at end of file
+}  // namespace av
@@ -0,0 +1,11 @@
+#include "FileWriter.h"
+#include "VideoEncoder.h"
+
+namespace av {
+
+// 依赖 OpenGL 的编码器单独放在这里，无界面构建不需要链接本文件
+IFileWriter* IFileWriter::Create(GLContext& glContext) {
+    return new FileWriter(std::make_shared<VideoEncoder>(glContext));
+}
+
+}  // namespace av
@@ -5,10 +5,15 @@
 #include "Define/FileWriterParameters.h"
 #include "Define/IAVPacket.h"
 
+struct AVStream;
+
 namespace av {
 
 struct IMuxer {
     virtual bool Configure(const std::string& outputFilePath, FileWriterParameters& parameters, int flags) = 0;
+    // 不重新编码，按源流的编码参数创建输出流，流为空时不创建
+    virtual bool ConfigureStreamCopy(const std::string& outputFilePath, const AVStream* audioStream,
+                                     const AVStream* videoStream) = 0;
     virtual void NotifyAudioPacket(std::shared_ptr<IAVPacket> packet) = 0;
     virtual void NotifyVideoPacket(std::shared_ptr<IAVPacket> packet) = 0;
     virtual void NotifyAudioFinished() = 0;
@@ -3,6 +3,7 @@
 #include "Define/FileWriterParameters.h"
 #include "Define/IAVPacket.h"
 #include "Define/IVideoFrame.h"
+#include "Define/VideoReadbackStats.h"
 
 namespace av {
 
@@ -16,6 +17,10 @@ struct IVideoEncoder {
     virtual void SetListener(Listener* listener) = 0;
     virtual bool Configure(FileWriterParameters& parameters, int flags) = 0;
     virtual void NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) = 0;
+    // 纹理读回统计，不经过 OpenGL 的编码器全部为 0
+    virtual VideoReadbackStats GetReadbackStats() = 0;
+
+    virtual ~IVideoEncoder() = default;
 };
 
 }  // namespace av
\ No newline at end of file
@@ -5,11 +5,19 @@
 namespace av {
 
 Muxer::~Muxer() {
+    std::lock_guard<std::mutex> lock(m_muxerMutex);
+    Finalize();
+}
+
+void Muxer::Finalize() {
     if (m_formatContext) {
-        av_write_trailer(m_formatContext);
-        avio_closep(&m_formatContext->pb);
+        // 文件头写入失败时没有可以结束的输出
+        if (m_isHeaderWritten) av_write_trailer(m_formatContext);
+        if (!(m_formatContext->oformat->flags & AVFMT_NOFILE)) avio_closep(&m_formatContext->pb);
         avformat_free_context(m_formatContext);
         m_formatContext = nullptr;
+        m_audioStream.avStream = nullptr;
+        m_videoStream.avStream = nullptr;
     }
 }
 
@@ -75,6 +83,42 @@ bool Muxer::Configure(const std::string& outputFilePath, FileWriterParameters& p
         }
     }
 
+    return WriteHeader(outputFilePath);
+}
+
+bool Muxer::ConfigureStreamCopy(const std::string& outputFilePath, const AVStream* audioStream,
+                                const AVStream* videoStream) {
+    std::lock_guard<std::mutex> lock(m_muxerMutex);
+
+    if (avformat_alloc_output_context2(&m_formatContext, nullptr, "mp4", outputFilePath.c_str()) < 0) {
+        std::cerr << "Could not create output context" << std::endl;
+        return false;
+    }
+
+    // 直接复制源流的编码参数，源中不存在的流视为已经结束
+    auto addStream = [this](StreamInfo& streamInfo, const AVStream* source) {
+        if (!source) {
+            streamInfo.isFinished = true;
+            return true;
+        }
+        streamInfo.avStream = avformat_new_stream(m_formatContext, nullptr);
+        if (!streamInfo.avStream || avcodec_parameters_copy(streamInfo.avStream->codecpar, source->codecpar) < 0) {
+            return false;
+        }
+        // 源容器的 codec tag 不一定适用于 mp4，由封装器重新选择
+        streamInfo.avStream->codecpar->codec_tag = 0;
+        streamInfo.avStream->time_base = source->time_base;
+        return true;
+    };
+    if (!addStream(m_audioStream, audioStream) || !addStream(m_videoStream, videoStream)) {
+        std::cerr << "Failed to create stream copy output streams" << std::endl;
+        return false;
+    }
+
+    return WriteHeader(outputFilePath);
+}
+
+bool Muxer::WriteHeader(const std::string& outputFilePath) {
     // 打开输出文件
     if (!(m_formatContext->oformat->flags & AVFMT_NOFILE)) {
         if (avio_open(&m_formatContext->pb, outputFilePath.c_str(), AVIO_FLAG_WRITE) < 0) {
@@ -94,6 +138,7 @@ bool Muxer::Configure(const std::string& outputFilePath, FileWriterParameters& p
         return false;
     }
 
+    m_isHeaderWritten = true;
     return true;
 }
 
@@ -104,9 +149,8 @@ void Muxer::NotifyAudioPacket(std::shared_ptr<IAVPacket> packet) {
     if (m_audioStream.avStream && !m_audioStream.isFinished) {
         auto avPacket = packet->avPacket;
         avPacket->stream_index = m_audioStream.avStream->index;
-        avPacket->pts = av_rescale_q(avPacket->pts, packet->timeBase, m_audioStream.avStream->time_base);
-        avPacket->dts = av_rescale_q(avPacket->dts, packet->timeBase, m_audioStream.avStream->time_base);
-        avPacket->duration = av_rescale_q(avPacket->duration, packet->timeBase, m_audioStream.avStream->time_base);
+        // 流复制的包可能没有 pts/dts，av_packet_rescale_ts 会保留 AV_NOPTS_VALUE
+        av_packet_rescale_ts(avPacket, packet->timeBase, m_audioStream.avStream->time_base);
         m_audioStream.packetQueue.push_back(packet);
         WriteInterleavedPackets();
     }
@@ -119,29 +163,35 @@ void Muxer::NotifyVideoPacket(std::shared_ptr<IAVPacket> packet) {
     if (m_videoStream.avStream && !m_videoStream.isFinished) {
         auto avPacket = packet->avPacket;
         avPacket->stream_index = m_videoStream.avStream->index;
-        avPacket->pts = av_rescale_q(avPacket->pts, packet->timeBase, m_videoStream.avStream->time_base);
-        avPacket->dts = av_rescale_q(avPacket->dts, packet->timeBase, m_videoStream.avStream->time_base);
-        avPacket->duration = av_rescale_q(avPacket->duration, packet->timeBase, m_videoStream.avStream->time_base);
+        av_packet_rescale_ts(avPacket, packet->timeBase, m_videoStream.avStream->time_base);
         m_videoStream.packetQueue.push_back(packet);
         WriteInterleavedPackets();
     }
 }
  
 void Muxer::WriteInterleavedPackets() {
-    while (!m_audioStream.packetQueue.empty() && !m_videoStream.packetQueue.empty()) {
-        auto audioPacket = m_audioStream.packetQueue.front();
-        auto videoPacket = m_videoStream.packetQueue.front();
-
-        // 分别使用每个包的时间基
-        double audioTime = audioPacket->avPacket->pts * av_q2d(m_audioStream.avStream->time_base);
-        double videoTime = videoPacket->avPacket->pts * av_q2d(m_videoStream.avStream->time_base);
-        std::cout << "audioTime: " << audioTime << ", videoTime: " << videoTime << std::endl;
+    while (!m_audioStream.packetQueue.empty() || !m_videoStream.packetQueue.empty()) {
+        // 某一路队列为空时，只有该路已经结束才能继续写另一路，否则等待以保证交织顺序
+        if (m_audioStream.packetQueue.empty() && !m_audioStream.isFinished) break;
+        if (m_videoStream.packetQueue.empty() && !m_videoStream.isFinished) break;
+
+        bool writeAudio = m_videoStream.packetQueue.empty();
+        if (!m_audioStream.packetQueue.empty() && !m_videoStream.packetQueue.empty()) {
+            // 分别使用每个包的时间基
+            double audioTime =
+                m_audioStream.packetQueue.front()->avPacket->pts * av_q2d(m_audioStream.avStream->time_base);
+            double videoTime =
+                m_videoStream.packetQueue.front()->avPacket->pts * av_q2d(m_videoStream.avStream->time_base);
+            writeAudio = audioTime <= videoTime;
+        }
 
-        if (audioTime <= videoTime) {
+        if (writeAudio) {
+            auto audioPacket = m_audioStream.packetQueue.front();
             m_audioStream.packetQueue.pop_front();
             av_interleaved_write_frame(m_formatContext, audioPacket->avPacket);
             av_packet_unref(audioPacket->avPacket);  // 释放写入后的包
         } else {
+            auto videoPacket = m_videoStream.packetQueue.front();
             m_videoStream.packetQueue.pop_front();
             av_interleaved_write_frame(m_formatContext, videoPacket->avPacket);
             av_packet_unref(videoPacket->avPacket);  // 释放写入后的包
@@ -153,12 +203,18 @@ void Muxer::NotifyAudioFinished() {
     std::cout << "Muxer::NotifyAudioFinished" << std::endl;
     std::lock_guard<std::mutex> lock(m_muxerMutex);
     m_audioStream.isFinished = true;
+    WriteInterleavedPackets();
+    // 两路都结束后立即写文件尾，文件在通知结束时即可使用
+    if (m_audioStream.isFinished && m_videoStream.isFinished) Finalize();
 }
 
 void Muxer::NotifyVideoFinished() {
     std::cout << "Muxer::NotifyVideoFinished" << std::endl;
     std::lock_guard<std::mutex> lock(m_muxerMutex);
     m_videoStream.isFinished = true;
+    WriteInterleavedPackets();
+    // 两路都结束后立即写文件尾，文件在通知结束时即可使用
+    if (m_audioStream.isFinished && m_videoStream.isFinished) Finalize();
 }
 
 }  // namespace av
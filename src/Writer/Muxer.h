@@ -25,13 +25,19 @@ public:
     // 继承 IMuxer
     //
     bool Configure(const std::string& outputFilePath, FileWriterParameters& parameters, int flags) override;
+    bool ConfigureStreamCopy(const std::string& outputFilePath, const AVStream* audioStream,
+                             const AVStream* videoStream) override;
     void NotifyAudioPacket(std::shared_ptr<IAVPacket> packet) override;
     void NotifyVideoPacket(std::shared_ptr<IAVPacket> packet) override;
     void NotifyAudioFinished() override;
     void NotifyVideoFinished() override;
 
 private:
+    // 打开输出文件并写文件头，调用方需持有 m_muxerMutex
+    bool WriteHeader(const std::string& outputFilePath);
     void WriteInterleavedPackets();
+    // 写文件尾并关闭输出，调用方需持有 m_muxerMutex
+    void Finalize();
 
 private:
     struct StreamInfo {
@@ -43,6 +49,7 @@ private:
 
     std::mutex m_muxerMutex;
     AVFormatContext* m_formatContext{nullptr};
+    bool m_isHeaderWritten{false};
 
     StreamInfo m_audioStream;
     StreamInfo m_videoStream;
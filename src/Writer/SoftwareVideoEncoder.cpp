@@ -0,0 +1,208 @@
+#include "SoftwareVideoEncoder.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace av {
+
+SoftwareVideoEncoder::~SoftwareVideoEncoder() {
+    StopThread();
+    if (m_swsCtx) sws_freeContext(m_swsCtx);
+    if (m_avFrame) av_frame_free(&m_avFrame);
+    if (m_avPacket) av_packet_free(&m_avPacket);
+    if (m_encodeCtx) avcodec_free_context(&m_encodeCtx);
+}
+
+void SoftwareVideoEncoder::SetListener(Listener* listener) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    m_listener = listener;
+}
+
+bool SoftwareVideoEncoder::Configure(FileWriterParameters& parameters, int flags) {
+    AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    if (!codec) {
+        std::cerr << "Codec not found" << std::endl;
+        return false;
+    }
+
+    m_encodeCtx = avcodec_alloc_context3(codec);
+    if (!m_encodeCtx) {
+        std::cerr << "Could not allocate video codec context" << std::endl;
+        return false;
+    }
+
+    m_encodeCtx->bit_rate = parameters.width * parameters.height * 4;
+    m_encodeCtx->width = parameters.width;
+    m_encodeCtx->height = parameters.height;
+    m_encodeCtx->time_base = {1, parameters.fps};
+    m_encodeCtx->framerate = {parameters.fps, 1};
+    m_encodeCtx->gop_size = 30;
+    m_encodeCtx->max_b_frames = 1;
+    m_encodeCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+
+    if (avcodec_open2(m_encodeCtx, codec, nullptr) < 0) {
+        std::cerr << "Could not open codec" << std::endl;
+        return false;
+    }
+
+    m_avFrame = av_frame_alloc();
+    if (!m_avFrame) {
+        std::cerr << "Could not allocate video frame" << std::endl;
+        return false;
+    }
+    m_avFrame->format = m_encodeCtx->pix_fmt;
+    m_avFrame->width = m_encodeCtx->width;
+    m_avFrame->height = m_encodeCtx->height;
+    m_avFrame->pts = 0;
+
+    auto ret = av_frame_get_buffer(m_avFrame, 1);
+    if (ret < 0) {
+        std::cerr << "av_frame_get_buffer failed!" << std::endl;
+        if (m_avFrame) av_frame_free(&m_avFrame);
+        return false;
+    }
+
+    m_avPacket = av_packet_alloc();
+    if (!m_avPacket) {
+        std::cerr << "Could not allocate AVPacket" << std::endl;
+        return false;
+    }
+
+    // 子类此时已构造完成，可以安全地在线程中调用虚函数
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&SoftwareVideoEncoder::ThreadLoop, this);
+        m_threadStarted = true;
+    }
+    return true;
+}
+
+void SoftwareVideoEncoder::NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    if (!videoFrame) return;
+    if (videoFrame->flags & static_cast<int>(AVFrameFlag::kEOS)) {
+        m_endOfStream = true;
+    } else {
+        // 编码跟不上时等待，不丢帧；编码线程未启动（配置失败）时直接放弃
+        m_videoFrameQueue.Push(std::move(videoFrame), [this]() { return m_abort.load() || !m_threadStarted.load(); });
+    }
+    m_notifier.Notify();
+}
+
+void SoftwareVideoEncoder::ThreadLoop() {
+    OnThreadStart();
+
+    while (!m_abort) {
+        std::shared_ptr<IVideoFrame> videoFrame;
+        if (m_videoFrameQueue.TryPop(videoFrame)) {
+            PrepareAndEncodeVideoFrame(videoFrame);
+        } else if (m_endOfStream.exchange(false)) {
+            // 队列中的帧全部编码后再冲刷编码器
+            while (auto pendingFrame = FlushPendingVideoFrame()) {
+                EncodeConvertedVideoFrame(*pendingFrame);
+            }
+            EncodeVideoFrame(nullptr);
+        } else {
+            m_notifier.Wait();
+        }
+    }
+
+    m_videoFrameQueue.Clear();
+    OnThreadStop();
+}
+
+void SoftwareVideoEncoder::StopThread() {
+    m_abort = true;
+    m_notifier.Notify();
+    m_videoFrameQueue.WakeProducer();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+std::shared_ptr<IVideoFrame> SoftwareVideoEncoder::ConvertVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    const uint8_t* srcData[4] = {nullptr};
+    int srcLinesize[4] = {0};
+    AVPixelFormat srcFormat = AV_PIX_FMT_NONE;
+    if (videoFrame->avFrame) {
+        // YUV 帧直接引用解码器输出，省去 RGBA 中转
+        for (int i = 0; i < 4; ++i) {
+            srcData[i] = videoFrame->avFrame->data[i];
+            srcLinesize[i] = videoFrame->avFrame->linesize[i];
+        }
+        srcFormat = static_cast<AVPixelFormat>(videoFrame->avFrame->format);
+    } else if (videoFrame->data) {
+        srcData[0] = videoFrame->data.get();
+        srcLinesize[0] = static_cast<int>(videoFrame->width) * 4;
+        srcFormat = AV_PIX_FMT_RGBA;
+    } else {
+        return nullptr;
+    }
+
+    int width = static_cast<int>(videoFrame->width);
+    int height = static_cast<int>(videoFrame->height);
+    m_swsCtx = sws_getCachedContext(m_swsCtx, width, height, srcFormat, m_encodeCtx->width, m_encodeCtx->height,
+                                    AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!m_swsCtx) {
+        std::cerr << "Could not create SwsContext for video encoder" << std::endl;
+        return nullptr;
+    }
+    // 编码器可能仍引用上一帧的缓冲区
+    if (av_frame_make_writable(m_avFrame) < 0) return nullptr;
+    if (sws_scale(m_swsCtx, srcData, srcLinesize, 0, height, m_avFrame->data, m_avFrame->linesize) <= 0) return nullptr;
+    return videoFrame;
+}
+
+void SoftwareVideoEncoder::PrepareAndEncodeVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    if (!m_avFrame || !m_avPacket) return;
+    if (auto convertedFrame = ConvertVideoFrame(videoFrame)) {
+        EncodeConvertedVideoFrame(*convertedFrame);
+    }
+}
+
+void SoftwareVideoEncoder::EncodeConvertedVideoFrame(const IVideoFrame& videoFrame) {
+    m_avFrame->pts = NextPts(videoFrame);
+    EncodeVideoFrame(m_avFrame);
+}
+
+int64_t SoftwareVideoEncoder::NextPts(const IVideoFrame& videoFrame) {
+    // 不带时间信息的帧（如滤镜输出的纹理）按固定帧率递增
+    if (videoFrame.timebaseDen <= 1 || videoFrame.pts == AV_NOPTS_VALUE) return m_avFrame->pts + 1;
+
+    // 带解码时间戳的帧按源时间排布，源帧率与编码帧率不同时音画仍然对齐
+    AVRational timeBase{videoFrame.timebaseNum, videoFrame.timebaseDen};
+    if (m_firstSourcePts == AV_NOPTS_VALUE) m_firstSourcePts = videoFrame.pts;
+    int64_t pts = av_rescale_q(videoFrame.pts - m_firstSourcePts, timeBase, m_encodeCtx->time_base);
+    // 编码器要求时间戳严格递增
+    return std::max(pts, m_avFrame->pts + 1);
+}
+
+void SoftwareVideoEncoder::EncodeVideoFrame(const AVFrame* avFrame) {
+    if (!m_encodeCtx || !m_avPacket) return;
+    int ret = avcodec_send_frame(m_encodeCtx, avFrame);
+    if (ret < 0) return;
+
+    while (ret >= 0) {
+        ret = avcodec_receive_packet(m_encodeCtx, m_avPacket);
+        if (ret == AVERROR(EAGAIN)) {
+            return;
+        } else if (ret == AVERROR_EOF) {
+            // 冲刷完成，继续向下通知结束
+            break;
+        } else if (ret < 0) {
+            std::cout << "Error encoding video frame: " << ret << std::endl;
+            return;
+        }
+
+        auto avPacket = std::make_shared<IAVPacket>(av_packet_clone(m_avPacket));
+        avPacket->timeBase = m_encodeCtx->time_base;
+
+        std::lock_guard<std::mutex> lock(m_listenerMutex);
+        if (m_listener) m_listener->OnVideoEncoderNotifyPacket(avPacket);
+
+        av_packet_unref(m_avPacket);
+    }
+
+    if (!avFrame) {
+        std::lock_guard<std::mutex> lock(m_listenerMutex);
+        if (m_listener) m_listener->OnVideoEncoderNotifyFinished();
+    }
+}
+
+}  // namespace av
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Core/SPSCQueue.h"
+#include "Core/SyncNotifier.h"
+#include "Interface/IVideoEncoder.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace av {
+
+// 直接从系统内存中的 RGBA / YUV 帧编码 H.264，不依赖 OpenGL
+// 编码线程在 Configure 成功后启动，子类可以在线程启动/结束时准备自己的环境，并接管帧的转换
+class SoftwareVideoEncoder : public IVideoEncoder {
+public:
+    SoftwareVideoEncoder() = default;
+    ~SoftwareVideoEncoder() override;
+
+    void SetListener(Listener* listener) override;
+    bool Configure(FileWriterParameters& parameters, int flags) override;
+    void NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) override;
+    VideoReadbackStats GetReadbackStats() override { return VideoReadbackStats{}; }
+
+protected:
+    // 编码线程中调用
+    virtual void OnThreadStart() {}
+    virtual void OnThreadStop() {}
+    // 将视频帧转换到 m_avFrame，返回像素已写入 m_avFrame 的帧
+    // 异步转换时返回的可能是更早提交的帧，返回 nullptr 表示暂时没有可以编码的帧
+    virtual std::shared_ptr<IVideoFrame> ConvertVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
+    // 冲刷编码器前依次取出尚未完成转换的帧，返回 nullptr 表示已全部取出
+    virtual std::shared_ptr<IVideoFrame> FlushPendingVideoFrame() { return nullptr; }
+
+    // 子类析构时需先停止线程，避免线程访问已销毁的子类成员
+    void StopThread();
+
+private:
+    void ThreadLoop();
+    void PrepareAndEncodeVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
+    void EncodeConvertedVideoFrame(const IVideoFrame& videoFrame);
+    int64_t NextPts(const IVideoFrame& videoFrame);
+    void EncodeVideoFrame(const AVFrame* frame);
+
+protected:
+    AVCodecContext* m_encodeCtx{nullptr};
+    SwsContext* m_swsCtx{nullptr};
+    AVFrame* m_avFrame{nullptr};
+
+private:
+    Listener* m_listener{nullptr};
+    std::mutex m_listenerMutex;
+
+    // 视频帧队列，生产者为视频处理线程，队列满时等待编码线程；结束标记可能来自其它线程，单独用标志位传递
+    static constexpr size_t kFrameQueueCapacity = 64;
+    SPSCQueue<std::shared_ptr<IVideoFrame>> m_videoFrameQueue{kFrameQueueCapacity};
+    std::atomic<bool> m_endOfStream{false};
+    SyncNotifier m_notifier;
+
+    std::atomic<bool> m_abort{false};
+    std::atomic<bool> m_threadStarted{false};
+    std::thread m_thread;
+
+    AVPacket* m_avPacket{nullptr};
+    int64_t m_firstSourcePts{AV_NOPTS_VALUE};
+};
+
+}  // namespace av
@@ -1,209 +1,186 @@
 #include "VideoEncoder.h"
 
+#include <chrono>
 #include <iostream>
 
-#include "Utils/GLUtils.h"
-#include "VideoFilter/VideoFilter.h"
-
 namespace av {
 
-VideoEncoder::VideoEncoder(GLContext& glContext) : m_sharedGLContext(glContext) {
-    m_thread = std::thread(&VideoEncoder::ThreadLoop, this);
-}
+namespace {
+// 等待栅栏的超时时间，单位纳秒
+constexpr uint64_t kFenceTimeout = 1000000000ull;
+}  // namespace
+
+VideoEncoder::VideoEncoder(GLContext& glContext) : m_sharedGLContext(glContext) {}
 
 VideoEncoder::~VideoEncoder() {
+    // 编码线程会调用本类的虚函数，必须在成员析构前停止
     StopThread();
-    if (m_swsCtx) sws_freeContext(m_swsCtx);
-    if (m_avFrame) av_frame_free(&m_avFrame);
-    if (m_avPacket) av_packet_free(&m_avPacket);
-    if (m_encodeCtx) avcodec_free_context(&m_encodeCtx);
-}
-
-void VideoEncoder::SetListener(Listener* listener) {
-    std::lock_guard<std::mutex> lock(m_listenerMutex);
-    m_listener = listener;
 }
 
-bool VideoEncoder::Configure(FileWriterParameters& parameters, int flags) {
-    AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_H264);
-    if (!codec) {
-        std::cerr << "Codec not found" << std::endl;
-        return false;
-    }
-
-    m_encodeCtx = avcodec_alloc_context3(codec);
-    if (!m_encodeCtx) {
-        std::cerr << "Could not allocate video codec context" << std::endl;
-        return false;
-    }
-
-    m_encodeCtx->bit_rate = parameters.width * parameters.height * 4;
-    m_encodeCtx->width = parameters.width;
-    m_encodeCtx->height = parameters.height;
-    m_encodeCtx->time_base = {1, parameters.fps};
-    m_encodeCtx->framerate = {parameters.fps, 1};
-    m_encodeCtx->gop_size = 30;
-    m_encodeCtx->max_b_frames = 1;
-    m_encodeCtx->pix_fmt = AV_PIX_FMT_YUV420P;
-
-    if (avcodec_open2(m_encodeCtx, codec, nullptr) < 0) {
-        std::cerr << "Could not open codec" << std::endl;
-        return false;
-    }
-
-    m_avFrame = av_frame_alloc();
-    if (!m_avFrame) {
-        std::cerr << "Could not allocate video frame" << std::endl;
-        return false;
-    }
-    m_avFrame->format = m_encodeCtx->pix_fmt;
-    m_avFrame->width = m_encodeCtx->width;
-    m_avFrame->height = m_encodeCtx->height;
-    m_avFrame->pts = 0;
-
-    auto ret = av_frame_get_buffer(m_avFrame, 1);
-    if (ret < 0) {
-        std::cerr << "av_frame_get_buffer failed!" << std::endl;
-        if (m_avFrame) av_frame_free(&m_avFrame);
-        return false;
-    }
-
-    m_avPacket = av_packet_alloc();
-    if (!m_avPacket) {
-        std::cerr << "Could not allocate AVPacket" << std::endl;
-        return false;
-    }
-
-    return true;
-}
-
-void VideoEncoder::NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
-    if (!videoFrame) return;
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_videoFrameQueue.push_back(videoFrame);
-    m_cond.notify_all();
-}
-
-void VideoEncoder::ThreadLoop() {
+void VideoEncoder::OnThreadStart() {
     m_sharedGLContext.Initialize();
     m_sharedGLContext.MakeCurrent();
+    initializeOpenGLFunctions();
 
-    unsigned int fbo{0};
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-    for (;;) {
-        {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            m_cond.wait(lock, [this] { return m_abort || !m_videoFrameQueue.empty(); });
-            if (m_abort) break;
-        }
-
-        std::shared_ptr<IVideoFrame> videoFrame;
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (m_videoFrameQueue.empty()) return;
+    glGenFramebuffers(1, &m_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
 
-            videoFrame = m_videoFrameQueue.front();
-            m_videoFrameQueue.pop_front();
-        }
-
-        if (videoFrame) {
-            auto isEndOfStream = videoFrame->flags & static_cast<int>(AVFrameFlag::kEOS);
-            isEndOfStream ? EncodeVideoFrame(nullptr) : PrepareAndEncodeVideoFrame(videoFrame);
-        }
+    for (auto& buffer : m_pixelBuffers) {
+        glGenBuffers(1, &buffer.pbo);
+        glGenQueries(1, &buffer.timestampQuery);
     }
+}
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_videoFrameQueue.clear();
+void VideoEncoder::OnThreadStop() {
+    for (auto& buffer : m_pixelBuffers) {
+        if (buffer.pbo) glDeleteBuffers(1, &buffer.pbo);
+        if (buffer.timestampQuery) glDeleteQueries(1, &buffer.timestampQuery);
+        // 栅栏在上下文仍为当前时释放
+        buffer = PixelBuffer();
     }
-
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDeleteFramebuffers(1, &fbo);
+    glDeleteFramebuffers(1, &m_fbo);
+    GLFence::CollectGarbage();
     m_sharedGLContext.DoneCurrent();
     m_sharedGLContext.Destroy();
 }
 
-void VideoEncoder::StopThread() {
-    m_abort = true;
-    m_cond.notify_all();
-    if (m_thread.joinable()) m_thread.join();
+VideoReadbackStats VideoEncoder::GetReadbackStats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
 }
 
-void VideoEncoder::FlipVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
-    if (!m_textureId) {
-        m_textureId = GLUtils::GenerateTexture(m_encodeCtx->width, m_encodeCtx->height, GL_RGBA, GL_RGBA);
-    }
+std::shared_ptr<IVideoFrame> VideoEncoder::ConvertVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
+    // 没有纹理的帧（例如系统内存中的 RGBA 帧）直接走软件转换
+    if (!videoFrame->textureId) return SoftwareVideoEncoder::ConvertVideoFrame(videoFrame);
+    if (videoFrame->fence) videoFrame->fence->WaitOnGPU();
 
-    // 垂直翻转画面
-    if (!m_flipVerticalFilter) {
-        m_flipVerticalFilter = std::shared_ptr<VideoFilter>(VideoFilter::Create(VideoFilterType::kFlipVertical));
-    }
-    if (m_flipVerticalFilter) {
-        m_flipVerticalFilter->Render(videoFrame, m_textureId);
-    }
-}
+    // 当前缓冲区中是三帧前发起的读回，此时通常已经完成，先取出再复用该缓冲区
+    auto& buffer = m_pixelBuffers[m_pixelBufferIndex];
+    std::shared_ptr<IVideoFrame> readyFrame;
+    if (buffer.frameInfo) readyFrame = FinishReadback(buffer);
 
-void VideoEncoder::ConvertTextureToFrame(unsigned int textureId, int width, int height) {
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
+    StartReadback(buffer, videoFrame);
+    m_pixelBufferIndex = (m_pixelBufferIndex + 1) % kPixelBufferCount;
+    return readyFrame;
+}
 
-    // 确保缓冲区大小合适
-    if (m_rgbaData.size() != width * height * 4) m_rgbaData.resize(width * height * 4);
+std::shared_ptr<IVideoFrame> VideoEncoder::FlushPendingVideoFrame() {
+    // 从最早发起的读回开始依次取出
+    for (size_t i = 0; i < kPixelBufferCount; ++i) {
+        auto& buffer = m_pixelBuffers[(m_pixelBufferIndex + i) % kPixelBufferCount];
+        if (!buffer.frameInfo) continue;
+        if (auto readyFrame = FinishReadback(buffer)) return readyFrame;
+    }
+    return nullptr;
+}
 
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, m_rgbaData.data());
+void VideoEncoder::StartReadback(PixelBuffer& buffer, const std::shared_ptr<IVideoFrame>& videoFrame) {
+    // 直接读取帧纹理，尺寸与编码尺寸不同时由 sws 缩放
+    int width = static_cast<int>(videoFrame->width);
+    int height = static_cast<int>(videoFrame->height);
+    size_t size = static_cast<size_t>(width) * height * 4;
 
-    uint8_t* srcSlice[1] = {m_rgbaData.data()};
-    int srcStride[1] = {4 * width};
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, videoFrame->textureId, 0);
 
-    if (!m_swsCtx) {
-        m_swsCtx = sws_getContext(width, height, AV_PIX_FMT_RGBA, m_encodeCtx->width, m_encodeCtx->height,
-                                  AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
-        if (!m_swsCtx) {
-            throw std::runtime_error("Could not reinitialize SwsContext with new dimensions");
-        }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    if (buffer.size != size) {
+        // 帧尺寸通常不变，只在首次使用或尺寸变化时分配
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        buffer.size = size;
     }
 
-    int result = sws_scale(m_swsCtx, srcSlice, srcStride, 0, height, m_avFrame->data, m_avFrame->linesize);
-    if (result <= 0) throw std::runtime_error("sws_scale failed");
+    // 目标为像素缓冲区时 glReadPixels 只记录拷贝命令，立即返回
+    glGetInteger64v(GL_TIMESTAMP, &buffer.issueTimestamp);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glQueryCounter(buffer.timestampQuery, GL_TIMESTAMP);
+    // 解除附着，帧纹理归还后本上下文不再引用它
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+
+    // 创建时已提交命令，保证栅栏最终会被触发；纹理池复用该纹理前等待同一个栅栏
+    buffer.fence = GLFence::Create();
+    videoFrame->SetConsumerFence(this, buffer.fence);
+
+    auto frameInfo = std::make_shared<IVideoFrame>();
+    frameInfo->flags = videoFrame->flags;
+    frameInfo->width = videoFrame->width;
+    frameInfo->height = videoFrame->height;
+    frameInfo->pts = videoFrame->pts;
+    frameInfo->duration = videoFrame->duration;
+    frameInfo->timebaseNum = videoFrame->timebaseNum;
+    frameInfo->timebaseDen = videoFrame->timebaseDen;
+    buffer.bottomUp = !videoFrame->textureFlipped;
+    buffer.frameInfo = std::move(frameInfo);
 }
 
-void VideoEncoder::PrepareAndEncodeVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) {
-    if (!m_avFrame || !m_avPacket) return;
-
-    FlipVideoFrame(videoFrame);
-
-    ConvertTextureToFrame(m_textureId, m_encodeCtx->width, m_encodeCtx->height);
-    ++m_avFrame->pts;
-    EncodeVideoFrame(m_avFrame);
-}
+std::shared_ptr<IVideoFrame> VideoEncoder::FinishReadback(PixelBuffer& buffer) {
+    auto frameInfo = std::move(buffer.frameInfo);
+    buffer.frameInfo = nullptr;
+    auto fence = std::move(buffer.fence);
+    buffer.fence = nullptr;
+    if (!fence) return nullptr;
+
+    bool completed = fence->WaitOnCPU(0);
+    double waitMs = 0.0;
+    if (!completed) {
+        // 拷贝尚未完成，统计仍需等待的时间
+        auto start = std::chrono::steady_clock::now();
+        completed = fence->WaitOnCPU(kFenceTimeout);
+        waitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (!completed) {
+        std::cerr << "Video encoder readback fence wait failed." << std::endl;
+        return nullptr;
+    }
 
-void VideoEncoder::EncodeVideoFrame(const AVFrame* avFrame) {
-    int ret = avcodec_send_frame(m_encodeCtx, avFrame);
-    if (ret < 0) return;
-
-    while (ret >= 0) {
-        ret = avcodec_receive_packet(m_encodeCtx, m_avPacket);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            return;
-        } else if (ret < 0) {
-            std::cout << "Error encoding audio frame: " << ret << std::endl;
-            return;
+    // 拷贝已完成，时间戳查询结果可以直接取得
+    GLuint64 completeTimestamp = 0;
+    glGetQueryObjectui64v(buffer.timestampQuery, GL_QUERY_RESULT, &completeTimestamp);
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.readbackCount;
+        if (waitMs > 0.0) ++m_stats.stalledCount;
+        m_stats.asynchronousStallMs += waitMs;
+        if (completeTimestamp > static_cast<GLuint64>(buffer.issueTimestamp)) {
+            m_stats.synchronousStallMs += (completeTimestamp - buffer.issueTimestamp) / 1e6;
         }
+    }
 
-        auto avPacket = std::make_shared<IAVPacket>(av_packet_clone(m_avPacket));
-        avPacket->timeBase = m_encodeCtx->time_base;
+    // glReadPixels 的首行为纹理首行：OpenGL 行序的纹理读出后首行是画面底部，需要翻转
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    auto* rgbaData = static_cast<const uint8_t*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(buffer.size), GL_MAP_READ_BIT));
+    bool converted = rgbaData && ConvertPixelsToFrame(rgbaData, static_cast<int>(frameInfo->width),
+                                                      static_cast<int>(frameInfo->height), buffer.bottomUp);
+    if (rgbaData) glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-        std::lock_guard<std::mutex> lock(m_listenerMutex);
-        if (m_listener) m_listener->OnVideoEncoderNotifyPacket(avPacket);
+    return converted ? frameInfo : nullptr;
+}
 
-        av_packet_unref(m_avPacket);
+bool VideoEncoder::ConvertPixelsToFrame(const uint8_t* rgbaData, int width, int height, bool bottomUp) {
+    const uint8_t* srcSlice[1] = {rgbaData};
+    int srcStride[1] = {4 * width};
+    if (bottomUp) {
+        // 从最后一行开始、负步长读取，转换的同时完成垂直翻转
+        srcSlice[0] = rgbaData + static_cast<size_t>(height - 1) * 4 * width;
+        srcStride[0] = -4 * width;
     }
 
-    if (!avFrame) {
-        std::lock_guard<std::mutex> lock(m_listenerMutex);
-        if (m_listener) m_listener->OnVideoEncoderNotifyFinished();
+    // 与软件路径共用转换上下文，参数变化时才重建
+    m_swsCtx = sws_getCachedContext(m_swsCtx, width, height, AV_PIX_FMT_RGBA, m_encodeCtx->width, m_encodeCtx->height,
+                                    AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!m_swsCtx) {
+        std::cerr << "Could not create SwsContext for video encoder" << std::endl;
+        return false;
     }
+
+    if (av_frame_make_writable(m_avFrame) < 0) return false;
+    return sws_scale(m_swsCtx, srcSlice, srcStride, 0, height, m_avFrame->data, m_avFrame->linesize) > 0;
 }
 
-}  // namespace av
\ No newline at end of file
+}  // namespace av
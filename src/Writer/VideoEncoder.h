@@ -1,58 +1,62 @@
 #pragma once
 
 #include "IGLContext.h"
-#include "Interface/IVideoEncoder.h"
+#include "SoftwareVideoEncoder.h"
+#include "Utils/GLFence.h"
 
-extern "C" {
-#include <libavcodec/avcodec.h>
-#include <libavformat/avformat.h>
-#include <libswscale/swscale.h>
-}
+#include <QOpenGLFunctions_3_3_Core>
+#include <array>
 #include <mutex>
-#include <thread>
 
 namespace av {
 
-class VideoFilter;
-
-class VideoEncoder : public IVideoEncoder {
+// 在共享 OpenGL 上下文中读回滤镜输出的纹理，再交给软件编码流程
+// 读回通过像素缓冲区环异步进行：第 N 帧的拷贝与第 N+1 帧的渲染重叠，映射时才等待栅栏
+// 像素拷贝到编码器自己的像素缓冲区后即释放源帧，不占用解码器的帧资源，纹理池凭栅栏判断拷贝何时完成
+class VideoEncoder : public SoftwareVideoEncoder, protected QOpenGLFunctions_3_3_Core {
 public:
     explicit VideoEncoder(GLContext& glContext);
-    ~VideoEncoder();
-    void SetListener(Listener* listener) override;
-    bool Configure(FileWriterParameters& parameters, int flags) override;
-    void NotifyVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) override;
+    ~VideoEncoder() override;
+
+    VideoReadbackStats GetReadbackStats() override;
+
+protected:
+    void OnThreadStart() override;
+    void OnThreadStop() override;
+    std::shared_ptr<IVideoFrame> ConvertVideoFrame(std::shared_ptr<IVideoFrame> videoFrame) override;
+    std::shared_ptr<IVideoFrame> FlushPendingVideoFrame() override;
 
 private:
-    void ThreadLoop();
-    void StopThread();
-    void FlipVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
-    void ConvertTextureToFrame(unsigned int textureId, int width, int height);
-    void PrepareAndEncodeVideoFrame(std::shared_ptr<IVideoFrame> videoFrame);
-    void EncodeVideoFrame(const AVFrame* frame);
+    // 一个像素缓冲区及其读回状态
+    struct PixelBuffer {
+        GLuint pbo{0};
+        GLuint timestampQuery{0};       // 拷贝完成时的 GPU 时间
+        GLint64 issueTimestamp{0};      // 发起拷贝时的 GPU 时间
+        std::shared_ptr<GLFence> fence;
+        size_t size{0};
+        bool bottomUp{false};  // 数据首行为画面底部，由读回时帧的纹理行序决定
+        // 只复制时间戳和尺寸，不持有纹理与解码器资源，编码时使用
+        std::shared_ptr<IVideoFrame> frameInfo;
+    };
+
+    // 发起异步读回，不等待 GPU；拷贝命令提交后源帧即可释放
+    void StartReadback(PixelBuffer& buffer, const std::shared_ptr<IVideoFrame>& videoFrame);
+    // 等待读回完成并把像素转换到 m_avFrame，返回对应的帧
+    std::shared_ptr<IVideoFrame> FinishReadback(PixelBuffer& buffer);
+    // bottomUp 表示数据首行为画面底部，通过负步长在转换时翻转
+    bool ConvertPixelsToFrame(const uint8_t* rgbaData, int width, int height, bool bottomUp);
 
 private:
     GLContext m_sharedGLContext;
+    unsigned int m_fbo{0};
 
-    Listener* m_listener{nullptr};
-    std::mutex m_listenerMutex;
-
-    // AVPacket 队列
-    std::list<std::shared_ptr<IVideoFrame>> m_videoFrameQueue;
-    std::condition_variable m_cond;
-    std::mutex m_mutex;
-
-    std::thread m_thread;
-    std::atomic<bool> m_abort{false};
-
-    std::shared_ptr<VideoFilter> m_flipVerticalFilter;  // 垂直翻转滤镜
-    unsigned int m_textureId{0};
+    // 三个缓冲区轮转，GPU 拷贝最多可以落后编码线程两帧
+    static constexpr size_t kPixelBufferCount = 3;
+    std::array<PixelBuffer, kPixelBufferCount> m_pixelBuffers;
+    size_t m_pixelBufferIndex{0};
 
-    AVCodecContext* m_encodeCtx{nullptr};
-    SwsContext* m_swsCtx{nullptr};
-    AVFrame* m_avFrame{nullptr};
-    AVPacket* m_avPacket{nullptr};
-    std::vector<uint8_t> m_rgbaData;
+    std::mutex m_statsMutex;
+    VideoReadbackStats m_stats;
 };
 
-}  // namespace av
\ No newline at end of file
+}  // namespace av